@@ -69,6 +69,12 @@ struct config_wrapper {
     void set_ingress_gas_limit(uint64_t gas_limit);
     uint64_t get_ingress_gas_limit() const;
 
+    void set_gc_budget(uint32_t budget);
+    uint32_t get_gc_budget() const;
+
+    void set_block_gas(const block_gas_params& params);
+    const block_gas_params& get_block_gas() const;
+
     void swapgastoken(name new_token_contract, symbol new_symbol);
 
 private:
@@ -3,6 +3,8 @@
 #include <eosio/singleton.hpp>
 #include <eosio/ignore.hpp>
 
+#include <map>
+
 #include <evm_runtime/types.hpp>
 #include <evm_runtime/transaction.hpp>
 #include <evm_runtime/runtime_config.hpp>
@@ -18,12 +20,14 @@ using namespace eosio;
 namespace evm_runtime {
 
 struct gas_prices_type;
+struct block_gas;
 
 class [[eosio::contract]] evm_contract : public contract
 {
 public:
    using contract::contract;
    evm_contract(eosio::name receiver, eosio::name code, const datastream<const char*>& ds);
+   ~evm_contract();
 
    /**
     * @brief Initialize EVM contract
@@ -61,7 +65,11 @@ public:
 
    [[eosio::action]] void exec(const exec_input& input, const std::optional<exec_callback>& callback);
 
-   [[eosio::action]] void pushtx(eosio::name miner, bytes rlptx, eosio::binary_extension<uint64_t> min_inclusion_price);
+   /**
+    * rlptx and min_inclusion_price are read directly from the action data so that the transaction does not get copied
+    * before being decoded.
+    */
+   [[eosio::action]] void pushtx(eosio::name miner, eosio::ignore<bytes> rlptx, eosio::ignore<eosio::binary_extension<uint64_t>> min_inclusion_price);
 
    [[eosio::action]] void open(eosio::name owner);
 
@@ -72,17 +80,79 @@ public:
 
    [[eosio::action]] void withdraw(eosio::name owner, eosio::asset quantity, const eosio::binary_extension<eosio::name> &to);
 
+   /**
+    * @brief Withdraw from the balance of owner to several accounts at once
+    *
+    * The balance of owner is debited once with the sum of all payouts and one token transfer is sent per payout.
+    */
+   [[eosio::action]] void withdrawmany(eosio::name owner, const std::vector<std::pair<eosio::name, eosio::asset>>& payouts);
+
+   /**
+    * @brief Bridge from the balance of owner to several EVM addresses at once
+    *
+    * The balance of owner is debited once, the ingress bridge fee is charged per credit and one EVM transaction is
+    * dispatched per credit, exactly like a transfer to the 0x address would.
+    */
+   [[eosio::action]] void bridgemany(eosio::name owner, const std::vector<std::pair<bytes, eosio::asset>>& credits);
+
    /// @return true if all garbage has been collected
    [[eosio::action]] bool gc(uint32_t max);
 
+   /**
+    * @brief Accounts with the most storage slots, page by page
+    *
+    * Scans at most scan account rows from the id cursor and returns the max largest of them (accounts not tracking
+    * slots are skipped). Callers merge the pages, starting at cursor 0 and following next until it is unset.
+    */
+   [[eosio::action, eosio::read_only]] storage_top_page topstorage(uint64_t cursor, uint32_t scan, uint32_t max);
+
+   /**
+    * @brief Incremental fingerprint of the EVM state
+    *
+    * The digest is the sum (mod 2^256) of keccak256(0x01 || address || nonce || balance || code_hash) over all accounts
+    * and keccak256(0x02 || address || key || value) over all non-zero storage slots. Addresses take 20 bytes, nonces 8
+    * bytes and the other fields 32 bytes, all big endian.
+    *
+    * @return the digest of the whole state, or only the one of address (its account and storage leaves) if given
+    */
+   [[eosio::action, eosio::read_only]] bytes getdigest(const std::optional<bytes>& address);
+
+   /**
+    * @brief Export the EVM state page by page
+    *
+    * Each action returns the rows starting at cursor (a primary key) that fit in max_bytes once packed, and the cursor
+    * of the next page. Pick max_bytes below the max_action_return_value_size of the chain.
+    */
+   [[eosio::action, eosio::read_only]] account_page exportaccts(uint64_t cursor, uint32_t max_bytes);
+   [[eosio::action, eosio::read_only]] code_page exportcode(uint64_t cursor, uint32_t offset, uint32_t max_bytes);
+   [[eosio::action, eosio::read_only]] storage_page exportstore(uint64_t account_id, uint64_t cursor, uint32_t max_bytes);
+
    
    [[eosio::action]] void call(eosio::name from, const bytes& to, const bytes& value, const bytes& data, uint64_t gas_limit);
    [[eosio::action]] void admincall(const bytes& from, const bytes& to, const bytes& value, const bytes& data, uint64_t gas_limit);
    [[eosio::action]] void callotherpay(eosio::name payer, eosio::name from, const bytes& to, const bytes& value, const bytes& data, uint64_t gas_limit);
 
-   [[eosio::action]] void bridgereg(eosio::name receiver, eosio::name handler, const eosio::asset& min_fee);
+   /**
+    * @brief Register (or update) a bridge message receiver
+    *
+    * @param flags Optional message_receiver flags on top of FORCE_ATOMIC. BATCH_DELIVERY makes the handler receive
+    *              all messages of one EVM transaction in a single onbridgemsgs(vector<bridge_message>) action.
+    *              ASYNC_DELIVERY queues messages that are not force_atomic instead of delivering them inline; they
+    *              are delivered later through pullmsgs. A queue holds at most max_queued_messages messages of up
+    *              to max_queued_message_size bytes of data, the EVM transaction emitting one more is rejected.
+    */
+   [[eosio::action]] void bridgereg(eosio::name receiver, eosio::name handler, const eosio::asset& min_fee, const eosio::binary_extension<uint32_t>& flags);
    [[eosio::action]] void bridgeunreg(eosio::name receiver);
 
+   /**
+    * @brief Deliver up to max queued (non-atomic) bridge messages of an ASYNC_DELIVERY receiver
+    *
+    * Anyone can call this action and pay for the CPU of the delivery.
+    *
+    * @return true if the queue of the receiver is empty
+    */
+   [[eosio::action]] bool pullmsgs(eosio::name receiver, uint32_t max);
+
    [[eosio::action]] void assertnonce(eosio::name account, uint64_t next_nonce);
 
    [[eosio::action]] void setversion(uint64_t version);
@@ -93,9 +163,54 @@ public:
    [[eosio::action]] void setgasprices(const gas_prices_type& prices);
    [[eosio::action]] void setgaslimit(uint64_t ingress_gas_limit);
 
+   /**
+    * @brief Set the number of gc rows that pushtx, transfer and withdraw collect on the fly (0 disables it)
+    */
+   [[eosio::action]] void setgcbudget(uint32_t budget);
+
+   /**
+    * @brief Track the gas used by each EVM block (soft_cap > 0) and let the base fee follow congestion
+    *
+    * Once the gas used by an EVM block reaches soft_cap, pushtx, call, callotherpay and admincall are rejected until the
+    * next EVM block; bridge transactions generated by the contract are counted but never rejected. With
+    * max_base_fee_multiplier >= 2 the base fee of each block is derived from the gas used by the previous one as in
+    * EIP-1559, targeting soft_cap / 2 and staying between the admin set price and max_base_fee_multiplier times it.
+    * Requires evm_version >= 1.
+    *
+    * While tracked, the fee income of a block is kept in its row and added to the statistics singleton by the first
+    * transaction of a later block (or when tracking stops), instead of rewriting the singleton on every transaction.
+    */
+   [[eosio::action]] void setblockgas(uint64_t soft_cap, uint32_t max_base_fee_multiplier);
+
+   /// @return the gas used, the base fee and the fee income not yet in the statistics of the last tracked EVM blocks,
+   /// oldest first
+   [[eosio::action, eosio::read_only]] std::vector<block_gas> getblockgas();
+
+   /**
+    * @brief Attach the state changes of each transaction to its evmtx event (evmtx_v4)
+    *
+    * Lets downstream EVM nodes apply the state without executing the transactions. Requires evm_version >= 3.
+    */
+   [[eosio::action]] void setstatediff(bool enabled);
+
    [[eosio::action]] void swapgastoken(eosio::name new_token_contract, eosio::symbol new_symbol, eosio::name swap_dest_account, std::string swap_memo);
    [[eosio::action]] void migratebal(eosio::name from_name, int limit);
 
+   /**
+    * @brief Move up to limit nonces of opened accounts, starting at from_name, from nextnonces into balances
+    */
+   [[eosio::action]] void migratenonce(eosio::name from_name, int limit);
+
+   /**
+    * @brief Build the state digest of a contract initialized before it was tracked, walking up to max rows
+    *
+    * Accounts are walked by id, each with its storage rows, resuming where the previous call stopped. The accounts
+    * already walked are tracked from then on, getdigest becomes available once the last one has been walked.
+    *
+    * @return true once the digest is seeded
+    */
+   [[eosio::action]] bool seeddigest(uint32_t max);
+
    // Events
    [[eosio::action]] void evmtx(eosio::ignore<evm_runtime::evmtx_type> event){
       eosio::check(get_sender() == get_self(), "forbidden to call");
@@ -114,6 +229,18 @@ public:
    [[eosio::action]] void addevmbal(uint64_t id, const bytes& delta, bool subtract);
    [[eosio::action]] void addopenbal(name account, const bytes& delta, bool subtract);
    [[eosio::action]] void freezeaccnt(uint64_t id, bool value);
+
+   /// @brief Drop the state digest and walk the state again with seeddigest, e.g. after it diverged from a reference
+   [[eosio::action]] void resetdigest();
+
+   /**
+    * @brief Write a batch of accounts, codes and storage slots, e.g. to give a new deployment a realistic genesis state
+    *
+    * Existing accounts get the nonce and balance of the batch and existing slots are overwritten. Codes are stored
+    * once per hash. The batch holds at most max_import_rows accounts and slots, and checksum must be the sha256 of
+    * its packed form.
+    */
+   [[eosio::action]] void importstate(const eosio::checksum256& checksum, eosio::ignore<state_batch> batch);
 #endif
 
 #ifdef WITH_TEST_ACTIONS
@@ -136,21 +263,39 @@ private:
 
    enum class status_flags : uint32_t
    {
-      frozen = 0x1
+      frozen = 0x1,
+      state_diff = 0x2
    };
 
    void assert_inited();
    void assert_unfrozen();
 
+   // Spend the configured gc_budget on pending garbage collection
+   void collect_garbage();
+
    silkworm::Receipt execute_tx(const runtime_config& rc, eosio::name miner, silkworm::Block& block, const transaction& tx, silkworm::ExecutionProcessor& ep, const evmone::gas_parameters& gas_params);
    void process_filtered_messages(std::function<bool(const silkworm::FilteredMessage&)> extra_filter, const std::vector<silkworm::FilteredMessage>& filtered_messages);
+   void deliver_bridge_messages(eosio::name handler, bool batched, const std::vector<bridge_message>& messages);
 
    uint64_t get_and_increment_nonce(const name owner);
 
    checksum256 get_code_hash(name account) const;
 
+   struct egress_account_properties {
+      bool is_account    = false;
+      bool has_code      = false;
+      bool on_allow_list = false;
+   };
+
+   // Memoized per action: the properties of an egress target cannot change while the action executes.
+   const egress_account_properties& get_egress_account_properties(eosio::name account);
+   std::map<uint64_t, egress_account_properties> _egress_account_cache;
+
    void handle_account_transfer(const eosio::asset& quantity, const std::string& memo);
    void handle_evm_transfer(eosio::asset quantity, const std::string& memo);
+   void bridge_to_evm(const evmc::address& destination, const eosio::asset& quantity, uint64_t txn_price);
+   // Shared by withdraw and withdrawmany: debits owner once with the sum of the payouts, one token transfer per payout
+   void withdraw_internal(eosio::name owner, const std::vector<std::pair<eosio::name, eosio::asset>>& payouts);
 
    void call_(const runtime_config& rc, intx::uint256 s, const bytes& to, intx::uint256 value, const bytes& data, uint64_t gas_limit, uint64_t nonce);
 
@@ -160,8 +305,29 @@ private:
    void dispatch_tx(const runtime_config& rc, const transaction& tx);
 
    uint64_t get_gas_price(uint64_t version);
-   struct statistics get_statistics() const;
+   uint64_t get_admin_gas_price(uint64_t version);
+
+   // The row of the current EVM block is read (or derived from the previous block) at most once per action and
+   // written back once, when the contract object is destroyed.
+   const block_gas& get_block_gas();
+   void check_block_gas_cap(const runtime_config& rc);
+   void add_block_gas(uint64_t gas_used);
+   void flush_block_gas();
+   void fold_fee_income(uint64_t before_block_num, eosio::symbol symbol);
+   uint64_t next_base_fee(const block_gas& prev, uint64_t block_num, uint64_t floor) const;
+   std::shared_ptr<struct block_gas> _block_gas;
+   bool _block_gas_dirty = false;
+
+   // While block gas is tracked the fee income goes to the blockgas row, which every transaction writes anyway, and
+   // reaches the statistics singleton once per EVM block. Otherwise it goes straight to the statistics.
+   void add_gas_fee_income(const intx::uint256& fee);
+   void add_ingress_fee_income(const eosio::asset& fee);
+   // Statistics are read at most once per action and written back once, when the contract object is destroyed.
+   struct statistics get_statistics();
    void set_statistics(const struct statistics &v);
+   void flush_statistics();
+   std::shared_ptr<struct statistics> _statistics;
+   bool _statistics_dirty = false;
 };
 
 } // namespace evm_runtime
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+namespace evm_runtime::memory_stats {
+
+// Instrumentation of WITH_MEMORY_STATS builds. begin() paints the free part of the stack when the contract object is
+// constructed, print() reports what the action used when it is destroyed:
+//
+//    mem_stats: <pages> <grown pages> <peak stack bytes> <allocations> <frees> <peak heap bytes>
+//
+// pages are 64 KiB linear memory pages at the end of the action (memory never shrinks, so this is the peak), grown
+// pages those added by the action. The stack high-water mark is measured below the frame of the contract constructor;
+// at most 1 MiB is painted (the 50 MB stack of WITH_LARGE_STACK would be written on every action), so it saturates at
+// about 1 MiB. Allocations, frees and the peak of live bytes count every form of operator new and delete, not malloc.
+void begin();
+void print();
+
+} // namespace evm_runtime::memory_stats
@@ -9,6 +9,7 @@ struct runtime_config {
   bool enforce_chain_id        = true;
   bool allow_non_self_miner    = true;
   std::optional<eosio::name> gas_payer;
+  bool enforce_block_gas_cap   = true; // <- false for bridge transactions, the tokens already moved
 };
 
 struct gas_parameter_type {
@@ -23,6 +23,9 @@ struct db_stats {
     table_stats storage;
 };
 
+struct account;
+struct storage;
+
 struct state : State {
     name _self;
     name _ram_payer;
@@ -30,13 +33,39 @@ struct state : State {
     bool _allow_frozen;
     mutable std::map<evmc::address, uint64_t> addr2id;
     mutable std::map<bytes32, bytes> addr2code;
+    mutable std::map<uint64_t, bytes32> id2codehash; // <- code rows are immutable, read each of them once per action
     mutable db_stats stats;
     std::optional<config2> _config2;
+    std::map<uint64_t, int64_t> _storage_slot_deltas; // <- per account id, applied to the account rows on destruction
+    std::optional<std::vector<state_change>> _state_diff; // <- only collected when enabled
+    std::optional<bool> _digest_enabled;
+    std::optional<digest_seed> _digest_seed; // <- seeddigest progress, loaded along with _digest_enabled
+    uint256 _digest_delta = 0;
+    std::map<uint64_t, uint256> _storage_digest_deltas; // <- per account id, applied to the account rows on destruction
+    uint256 _seed_digest_delta = 0; // <- storage rows seeddigest already walked, applied to the seed on destruction
+    int64_t _seed_slot_delta = 0;
 
     explicit state(name self, name ram_payer, bool read_only=false, bool allow_frozen=true) : _self(self), _ram_payer(ram_payer), _read_only{read_only}, _allow_frozen{allow_frozen}{}
     virtual ~state() override;
 
     uint64_t get_next_account_id();
+    void adjust_storage_slots(uint64_t account_id, int64_t delta) { _storage_slot_deltas[account_id] += delta; }
+    void flush_account_deltas(); // <- slot counts, storage digests and the global digest, one write per account row
+
+    void enable_state_diff() { _state_diff.emplace(); }
+
+    // Incremental state fingerprint: the sum (mod 2^256) of one keccak256 leaf per account and per storage slot.
+    // It is only maintained when the statedigest singleton exists (created by init, or by seeddigest for contracts
+    // initialized before it existed). While seeddigest runs, only the accounts and rows it already walked are tracked.
+    bool digest_enabled();
+    bool digest_covers(uint64_t account_id); // <- false for the accounts seeddigest has not completed yet
+    uint256 account_leaf(const account& row) const;
+    uint256 slot_leaf(const bytes& address, const bytes& key, const bytes& value) const;
+    evmc::bytes32 code_hash_of(uint64_t code_id) const; // <- through id2codehash, the code row is read once per action
+    uint256 account_digest(const account& row) const; // <- account leaf plus the leaves of its storage
+    void digest_account(const account& row, bool add);
+    void digest_slot(uint64_t account_id, const bytes& address, const storage& slot, bool add);
+    void digest_remove_account(const account& row);
 
     std::optional<Account> read_account(const evmc::address& address) const noexcept override;
 
@@ -28,6 +28,8 @@ struct [[eosio::table]] [[eosio::contract("evm_contract")]] account {
     bytes       balance;
     std::optional<uint64_t> code_id;
     binary_extension<uint32_t> flags=0;
+    binary_extension<uint64_t> storage_slots; // <- number of rows in the storage table, unset for accounts created before it was tracked
+    binary_extension<bytes> storage_digest; // <- sum of the state digest leaves of the storage table, see statedigest
 
     void set_flag(flag f) {
         flags.value() |= static_cast<uint32_t>(f);
@@ -53,7 +55,7 @@ struct [[eosio::table]] [[eosio::contract("evm_contract")]] account {
         return res;
     }
 
-    EOSLIB_SERIALIZE(account, (id)(eth_address)(nonce)(balance)(code_id)(flags));
+    EOSLIB_SERIALIZE(account, (id)(eth_address)(nonce)(balance)(code_id)(flags)(storage_slots)(storage_digest));
 };
 
 typedef multi_index< "account"_n, account,
@@ -104,10 +106,11 @@ typedef multi_index< "storage"_n, storage,
 struct [[eosio::table]] [[eosio::contract("evm_contract")]] gcstore {
     uint64_t id;
     uint64_t storage_id;
+    binary_extension<uint64_t> storage_slots; // <- rows left to collect, when known
 
     uint64_t primary_key()const { return id; }
 
-    EOSLIB_SERIALIZE(gcstore, (id)(storage_id));
+    EOSLIB_SERIALIZE(gcstore, (id)(storage_id)(storage_slots));
 };
 
 typedef multi_index< "gcstore"_n, gcstore> gc_store_table;
@@ -187,16 +190,19 @@ struct [[eosio::table("inevm")]] [[eosio::contract("evm_contract")]] balance_wit
 struct [[eosio::table]] [[eosio::contract("evm_contract")]] balance {
     name              owner;
     balance_with_dust balance;
+    binary_extension<uint64_t> next_nonce; // <- unset for rows whose nonce still lives in nextnonces (see migratenonce)
 
     uint64_t primary_key() const { return owner.value; }
 
-    EOSLIB_SERIALIZE(struct balance, (owner)(balance));
+    EOSLIB_SERIALIZE(struct balance, (owner)(balance)(next_nonce));
 };
 
 typedef eosio::multi_index<"balances"_n, balance> balances;
 
 typedef eosio::singleton<"inevm"_n, balance_with_dust> inevm_singleton;
 
+// Only used by closed accounts that need to keep their nonce and by rows opened before the nonce was moved into
+// the balances table.
 struct [[eosio::table]] [[eosio::contract("evm_contract")]] nextnonce {
     name     owner;
     uint64_t next_nonce = 0;
@@ -221,7 +227,11 @@ typedef eosio::multi_index<"egresslist"_n, allowed_egress_account> egresslist;
 struct [[eosio::table]] [[eosio::contract("evm_contract")]] message_receiver {
 
     enum flag : uint32_t {
-        FORCE_ATOMIC = 0x1
+        FORCE_ATOMIC   = 0x1,
+        BATCH_DELIVERY = 0x2,  // deliver all messages of a transaction in a single onbridgemsgs action
+        ASYNC_DELIVERY = 0x4,  // queue non-atomic messages in msgqueue, to be drained with pullmsgs
+
+        OPTIONAL_FLAGS = BATCH_DELIVERY | ASYNC_DELIVERY
     };
 
     name     account;
@@ -239,6 +249,18 @@ struct [[eosio::table]] [[eosio::contract("evm_contract")]] message_receiver {
 
 typedef eosio::multi_index<"msgreceiver"_n, message_receiver> message_receiver_table;
 
+// Scoped by receiver
+struct [[eosio::table]] [[eosio::contract("evm_contract")]] queued_message {
+    uint64_t       id;
+    bridge_message message;
+
+    uint64_t primary_key() const { return id; }
+
+    EOSLIB_SERIALIZE(queued_message, (id)(message));
+};
+
+typedef eosio::multi_index<"msgqueue"_n, queued_message> message_queue_table;
+
 struct [[eosio::table]] [[eosio::contract("evm_contract")]] config2
 {
     uint64_t next_account_id{0};
@@ -246,6 +268,25 @@ struct [[eosio::table]] [[eosio::contract("evm_contract")]] config2
     EOSLIB_SERIALIZE(config2, (next_account_id));
 };
 
+struct digest_seed
+{
+    uint64_t account_id = 0; // <- account being walked, the ones below it are part of the digest
+    uint64_t slot_id = 0; // <- next storage row of account_id to walk
+    bytes    storage_digest = bytes(32, 0); // <- leaves of the storage rows of account_id below slot_id
+    uint64_t storage_slots = 0; // <- number of those rows
+
+    EOSLIB_SERIALIZE(digest_seed, (account_id)(slot_id)(storage_digest)(storage_slots));
+};
+
+struct [[eosio::table]] [[eosio::contract("evm_contract")]] state_digest
+{
+    bytes digest; // <- 32 bytes big endian, sum (mod 2^256) of the leaves of all accounts and storage slots
+    binary_extension<digest_seed> seed; // <- set while seeddigest is still walking the state
+
+    EOSLIB_SERIALIZE(state_digest, (digest)(seed));
+};
+typedef eosio::singleton<"statedigest"_n, state_digest> state_digest_singleton;
+
 struct gas_prices_type {
     std::optional<uint64_t> overhead_price;
     std::optional<uint64_t> storage_price;
@@ -259,6 +300,17 @@ struct gas_prices_type {
     }
 };
 
+struct block_gas_params {
+    uint64_t soft_cap = 0;                  // <- max gas per EVM block for non bridge transactions, 0 disables gas tracking
+    uint32_t max_base_fee_multiplier = 0;   // <- the base fee moves between the admin price and this multiple of it, < 2 keeps it fixed
+
+    bool dynamic_base_fee()const {
+        return soft_cap > 0 && max_base_fee_multiplier > 1;
+    }
+
+    EOSLIB_SERIALIZE(block_gas_params, (soft_cap)(max_base_fee_multiplier));
+};
+
 using evm_version_type = uint64_t;
 
 VALUE_PROMOTER(evm_version_type);
@@ -279,9 +331,27 @@ struct [[eosio::table]] [[eosio::contract("evm_contract")]] config
     binary_extension<uint32_t> queue_front_block;
     binary_extension<uint64_t> ingress_gas_limit;
     binary_extension<gas_prices_type> gas_prices;
+    binary_extension<uint32_t> gc_budget; // <- max rows collected by each pushtx/transfer/withdraw, 0 disables it
+    binary_extension<block_gas_params> block_gas;
+
+    EOSLIB_SERIALIZE(config, (version)(chainid)(genesis_time)(ingress_bridge_fee)(gas_price)(miner_cut)(status)(evm_version)(consensus_parameter)(token_contract)(queue_front_block)(ingress_gas_limit)(gas_prices)(gc_budget)(block_gas));
+};
+
+// Gas used by the last EVM blocks, only kept while block gas tracking is enabled
+struct [[eosio::table]] [[eosio::contract("evm_contract")]] block_gas
+{
+    uint64_t block_num;
+    uint64_t gas_used = 0;
+    uint64_t base_fee = 0; // <- dynamic base fee of the block, 0 when it is not enabled
+    // Fee income of the block, moved into the statistics singleton when a later block is tracked
+    balance_with_dust gas_fee_income;
+    balance_with_dust ingress_bridge_fee_income;
+
+    uint64_t primary_key()const { return block_num; }
 
-    EOSLIB_SERIALIZE(config, (version)(chainid)(genesis_time)(ingress_bridge_fee)(gas_price)(miner_cut)(status)(evm_version)(consensus_parameter)(token_contract)(queue_front_block)(ingress_gas_limit)(gas_prices));
+    EOSLIB_SERIALIZE(block_gas, (block_num)(gas_used)(base_fee)(gas_fee_income)(ingress_bridge_fee_income));
 };
+typedef eosio::multi_index<"blockgas"_n, block_gas> block_gas_table;
 
 struct [[eosio::table]] [[eosio::contract("evm_contract")]] price_queue
 {
@@ -14,26 +14,33 @@ using silkworm::ByteView;
 struct transaction {
 
   transaction() = delete;
-  explicit transaction(bytes rlptx) : rlptx_(std::move(rlptx)) {}
+  // rlptx_view_ may point into rlptx_, moving keeps the buffer but copying would not
+  transaction(const transaction&) = delete;
+  transaction(transaction&&) = default;
+  explicit transaction(bytes rlptx) : rlptx_(std::move(rlptx)) {
+    rlptx_view_.emplace((const uint8_t*)rlptx_->data(), rlptx_->size());
+  }
+  // The rlp is not copied, the memory it points to (usually the action data) must outlive the transaction
+  explicit transaction(ByteView rlptx) : rlptx_view_(rlptx) {}
   explicit transaction(silkworm::Transaction tx) : tx_(std::move(tx)) {}
 
-  const bytes& get_rlptx()const {
-    if(!rlptx_) {
+  ByteView get_rlptx()const {
+    if(!rlptx_view_) {
       eosio::check(tx_.has_value(), "no tx");
       Bytes rlp;
       silkworm::rlp::encode(rlp, tx_.value());
       rlptx_.emplace(bytes{rlp.begin(), rlp.end()});
+      rlptx_view_.emplace((const uint8_t*)rlptx_->data(), rlptx_->size());
     }
-    return rlptx_.value();
+    return *rlptx_view_;
   }
 
   const silkworm::Transaction& get_tx()const {
     if(!tx_) {
-      eosio::check(rlptx_.has_value(), "no rlptx");
-      ByteView bv{(const uint8_t*)rlptx_->data(), rlptx_->size()};
-      silkworm::Transaction tmp;
-      eosio::check(silkworm::rlp::decode_transaction(bv, tmp, silkworm::rlp::Eip2718Wrapping::kNone) && bv.empty(), "unable to decode transaction");
-      tx_.emplace(tmp);
+      eosio::check(rlptx_view_.has_value(), "no rlptx");
+      ByteView bv{*rlptx_view_};
+      // decode in place, no temporary to copy from
+      eosio::check(silkworm::rlp::decode_transaction(bv, tx_.emplace(), silkworm::rlp::Eip2718Wrapping::kNone) && bv.empty(), "unable to decode transaction");
     }
     return tx_.value();
   }
@@ -47,6 +54,7 @@ struct transaction {
 
 private:
   mutable std::optional<bytes>  rlptx_;
+  mutable std::optional<ByteView> rlptx_view_;
   mutable std::optional<silkworm::Transaction> tx_;
 };
 
@@ -15,6 +15,10 @@ namespace evm_runtime {
    static constexpr uint64_t one_gwei = 1'000'000'000ull;
    static constexpr uint64_t gas_sset_min = 2900;
    static constexpr uint64_t grace_period_seconds = 180;
+   static constexpr uint32_t max_import_rows = 1000; // <- accounts, storage slots and codes per importstate batch
+   static constexpr uint32_t block_gas_window = 8; // <- EVM blocks kept in the blockgas table
+   static constexpr uint32_t max_queued_messages = 256; // <- per ASYNC_DELIVERY receiver, the contract pays their RAM
+   static constexpr uint32_t max_queued_message_size = 1024; // <- bytes of data of a queued bridge message
 
    uint64_t pow10_const(int v);
 
@@ -66,6 +70,96 @@ namespace evm_runtime {
       EOSLIB_SERIALIZE(exec_output, (status)(data)(context));
    };
 
+   struct account_storage {
+      uint64_t id;
+      bytes    eth_address;
+      uint64_t storage_slots;
+
+      EOSLIB_SERIALIZE(account_storage, (id)(eth_address)(storage_slots));
+   };
+
+   struct storage_top_page {
+      std::vector<account_storage> accounts; // <- largest first
+      std::optional<uint64_t>      next;     // <- account id to continue the scan from, unset on the last page
+
+      EOSLIB_SERIALIZE(storage_top_page, (accounts)(next));
+   };
+
+   // Pages returned by the state export actions
+   struct exported_account {
+      uint64_t id;
+      bytes    address;
+      uint64_t nonce;
+      bytes    balance;
+      bytes    code_hash; // <- empty for accounts without code
+
+      EOSLIB_SERIALIZE(exported_account, (id)(address)(nonce)(balance)(code_hash));
+   };
+
+   struct account_page {
+      std::vector<exported_account> accounts;
+      std::optional<uint64_t>       next; // <- cursor of the next page, unset on the last one
+
+      EOSLIB_SERIALIZE(account_page, (accounts)(next));
+   };
+
+   struct exported_code {
+      uint64_t id;
+      bytes    code_hash;
+      uint32_t size;   // <- of the whole code
+      uint32_t offset; // <- of data within the code
+      bytes    data;
+
+      EOSLIB_SERIALIZE(exported_code, (id)(code_hash)(size)(offset)(data));
+   };
+
+   struct code_page {
+      std::vector<exported_code> codes;
+      std::optional<uint64_t>    next;
+      uint32_t                   next_offset = 0; // <- codes larger than a page continue at this offset
+
+      EOSLIB_SERIALIZE(code_page, (codes)(next)(next_offset));
+   };
+
+   struct exported_slot {
+      bytes key;
+      bytes value;
+
+      EOSLIB_SERIALIZE(exported_slot, (key)(value));
+   };
+
+   struct storage_page {
+      std::vector<exported_slot> slots;
+      std::optional<uint64_t>    next;
+
+      EOSLIB_SERIALIZE(storage_page, (slots)(next));
+   };
+
+   // Batch of the importstate admin action
+   struct imported_slot {
+      bytes key;
+      bytes value; // <- a zero value clears the slot
+
+      EOSLIB_SERIALIZE(imported_slot, (key)(value));
+   };
+
+   struct imported_account {
+      bytes                      address;
+      uint64_t                   nonce;
+      bytes                      balance;
+      std::optional<bytes>       code_hash; // <- code already stored or part of the batch
+      std::vector<imported_slot> storage;
+
+      EOSLIB_SERIALIZE(imported_account, (address)(nonce)(balance)(code_hash)(storage));
+   };
+
+   struct state_batch {
+      std::vector<bytes>            codes; // <- only the codes not stored yet, keyed by their keccak256
+      std::vector<imported_account> accounts;
+
+      EOSLIB_SERIALIZE(state_batch, (codes)(accounts));
+   };
+
    struct bridge_message_v0 {
       eosio::name        receiver;
       bytes              sender;
@@ -95,7 +189,46 @@ namespace evm_runtime {
       EOSLIB_SERIALIZE_DERIVED(evmtx_v3, evmtx_base, (overhead_price)(storage_price));
    };
 
-   using evmtx_type = std::variant<evmtx_v1, evmtx_v3>;
+   // State changes of one transaction, in the order they were applied to the contract tables
+   struct account_state {
+      uint64_t  nonce;
+      bytes     balance;
+
+      EOSLIB_SERIALIZE(account_state, (nonce)(balance));
+   };
+
+   struct account_change {
+      bytes                         address;
+      std::optional<account_state>  current; // <- unset if the account and its storage were removed
+      bool                          reset;   // <- previous incarnation and its storage removed before recreating it
+
+      EOSLIB_SERIALIZE(account_change, (address)(current)(reset));
+   };
+
+   struct code_change {
+      bytes  address;
+      bytes  code_hash;
+      bytes  code;    // <- empty if the code was already known to the contract
+
+      EOSLIB_SERIALIZE(code_change, (address)(code_hash)(code));
+   };
+
+   struct storage_change {
+      bytes  address;
+      bytes  key;
+      bytes  value;   // <- empty if the slot was cleared
+
+      EOSLIB_SERIALIZE(storage_change, (address)(key)(value));
+   };
+
+   using state_change = std::variant<account_change, code_change, storage_change>;
+
+   struct evmtx_v4 : evmtx_v3 {
+      std::vector<state_change> state_diff;
+      EOSLIB_SERIALIZE_DERIVED(evmtx_v4, evmtx_v3, (state_diff));
+   };
+
+   using evmtx_type = std::variant<evmtx_v1, evmtx_v3, evmtx_v4>;
 
    struct fee_parameters
    {
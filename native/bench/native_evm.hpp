@@ -0,0 +1,141 @@
+#pragma once
+
+#include <bit>
+#include <optional>
+
+#include <eosio/eosio.hpp>
+
+#include <ethash/keccak.hpp>
+
+#include <evm_runtime/runtime_config.hpp>
+#include <evm_runtime/state.hpp>
+#include <evm_runtime/tables.hpp>
+
+#include <silkworm/core/chain/config.hpp>
+#include <silkworm/core/execution/processor.hpp>
+#include <silkworm/core/protocol/trust_rule_set.hpp>
+#include <silkworm/core/protocol/validation.hpp>
+
+namespace evm_native {
+
+using namespace eosio;
+
+// Reduced native counterpart of evm_contract::process_tx/execute_tx for regular (non bridge) transactions.
+//
+// src/actions.cpp is NOT compiled here: this is a copy of the EVM part of execute_tx only. It runs the same block
+// header, rule set, evm_runtime::state and ExecutionProcessor calls, each transaction in its own state like each pushtx
+// action does, so it measures the interpreter and the account/storage/code tables. It does not measure what
+// execute_tx writes around that: the balances, statistics, inevm and egress (reserved addresses, bridge messages)
+// tables, the evmtx event, the config reads and the block gas tracking. Gas parameters and prices come from options
+// instead of the config singleton, set them to the values of the chain being profiled. Sender recovery is skipped,
+// transactions come with their sender set.
+class native_evm {
+public:
+   static constexpr name self = "eosio.evm"_n;
+
+   struct options {
+      uint64_t                        chain_id       = 15555;
+      uint64_t                        evm_version    = 3;
+      uint64_t                        gas_price      = 150'000'000'000; // <- base fee from v1 on
+      uint64_t                        overhead_price = 150'000'000'000; // <- from v3 on, see setgasprices
+      uint64_t                        storage_price  = 150'000'000'000;
+      evm_runtime::gas_parameter_type gas_parameter;                    // <- see updtgasparam
+      uint32_t                        genesis_time   = 1'700'000'000;
+   };
+
+   explicit native_evm(const options& opts = {}) : _opts(opts), _bm(opts.genesis_time) {
+      auto chain = silkworm::lookup_known_chain(opts.chain_id);
+      check(chain.has_value(), "unknown chainid");
+      _chain_config = chain->second;
+
+      native::set_current_receiver(self);
+      native::set_current_time(time_point(seconds(opts.genesis_time + 1)));
+   }
+
+   // Moves the clock to the next EVM block
+   void next_block() {
+      native::set_current_time(current_time_point() + seconds(1));
+   }
+
+   uint64_t block_num() const {
+      return _bm.timestamp_to_evm_block_num(current_time_point().time_since_epoch().count());
+   }
+
+   // Creates or overwrites an account, outside of any transaction
+   void set_account(const evmc::address& address, uint64_t nonce, const intx::uint256& balance,
+                    const silkworm::Bytes& code = {}) {
+      evm_runtime::state state{self, self};
+      const auto initial = state.read_account(address);
+
+      silkworm::Account account{nonce, balance, silkworm::kEmptyHash, 0};
+      if (!code.empty()) account.code_hash = std::bit_cast<evmc::bytes32>(ethash::keccak256(code.data(), code.size()));
+      state.update_account(address, initial, account);
+      if (!code.empty()) state.update_account_code(address, 0, account.code_hash, code);
+   }
+
+   void set_storage(const evmc::address& address, const evmc::bytes32& key, const evmc::bytes32& value) {
+      evm_runtime::state state{self, self};
+      state.update_storage(address, 0, key, state.read_storage(address, 0, key), value);
+   }
+
+   silkworm::Transaction make_tx(const evmc::address& from, uint64_t nonce, std::optional<evmc::address> to,
+                                 const silkworm::Bytes& data, uint64_t gas_limit, const intx::uint256& value = 0) const {
+      silkworm::Transaction txn;
+      txn.type = silkworm::TransactionType::kLegacy;
+      txn.nonce = nonce;
+      txn.max_priority_fee_per_gas = _opts.gas_price;
+      txn.max_fee_per_gas = _opts.gas_price;
+      txn.gas_limit = gas_limit;
+      txn.to = to;
+      txn.value = value;
+      txn.data = data;
+      txn.r = 0u; // <- pseudo signature, as the ones generated by the call action
+      txn.s = 1u;
+      txn.from = from;
+      return txn;
+   }
+
+   struct result {
+      silkworm::Receipt      receipt;
+      evm_runtime::db_stats  stats;
+   };
+
+   result execute(const silkworm::Transaction& txn) {
+      silkworm::Block block;
+      std::optional<uint64_t> base_fee_per_gas;
+      if (_opts.evm_version >= 1) base_fee_per_gas = _opts.gas_price;
+      eosevm::prepare_block_header(block.header, _bm, self.value, block_num(), _opts.evm_version, base_fee_per_gas);
+
+      silkworm::protocol::TrustRuleSet engine{*_chain_config};
+      evm_runtime::state state{self, self, false, false};
+
+      const auto& gp = _opts.gas_parameter;
+      const evmone::gas_parameters gas_params(gp.gas_txnewaccount, gp.gas_newaccount, gp.gas_txcreate,
+                                              gp.gas_codedeposit, gp.gas_sset);
+      silkworm::gas_prices_t gas_prices{_opts.overhead_price, _opts.storage_price};
+      silkworm::ExecutionProcessor ep{block, engine, state, *_chain_config, gas_prices};
+
+      auto r = silkworm::protocol::pre_validate_transaction(txn, ep.evm().revision(), ep.evm().config().chain_id,
+                  ep.evm().block().header.base_fee_per_gas, ep.evm().block().header.data_gas_price(),
+                  ep.evm().get_eos_evm_version(), gas_params);
+      check(r == silkworm::ValidationResult::kOk, "pre_validate_transaction error: " + std::to_string(uint64_t(r)));
+      r = silkworm::protocol::validate_transaction(txn, ep.state(), ep.available_gas());
+      check(r == silkworm::ValidationResult::kOk, "validate_transaction error: " + std::to_string(uint64_t(r)));
+
+      result res;
+      silkworm::CallResult call_result;
+      ep.execute_transaction(txn, res.receipt, gas_params, call_result);
+
+      engine.finalize(ep.state(), ep.evm().block());
+      ep.state().write_to_db(ep.evm().block().header.number);
+      res.stats = state.stats;
+      return res;
+   }
+
+private:
+   options                        _opts;
+   eosevm::block_mapping          _bm;
+   const silkworm::ChainConfig*   _chain_config = nullptr;
+};
+
+} // namespace evm_native
@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "native_evm.hpp"
+
+// Microbenchmarks of the contract state layer built natively, to be run under perf:
+//
+//    perf record -g ./evm_state_bench --accounts 1000000 erc20_transfer
+//
+// Each operation runs in a fresh evm_runtime::state, as every pushtx action does on chain.
+
+using namespace evm_native;
+
+namespace {
+
+// runtime code of a minimal token: transfer(to, amount) moving amount from balances[caller] to balances[to], balances
+// being a solidity mapping at slot 0
+constexpr const char* token_code = "33600052600060205260406000208054602435808210603057808203835560043560005260406000208054820190550"
+                                   "05b600080fd";
+
+const evmc::address token_address = 0x7070707070707070707070707070707070707070_address;
+
+evmc::address holder(uint64_t i) {
+   evmc::address res;
+   res.bytes[0] = 0x11;
+   for (int b = 0; b < 8; ++b) res.bytes[19 - b] = static_cast<uint8_t>(i >> (8 * b));
+   return res;
+}
+
+evmc::bytes32 word(const intx::uint256& v) {
+   evmc::bytes32 res;
+   intx::be::store(res.bytes, v);
+   return res;
+}
+
+evmc::bytes32 balance_slot(const evmc::address& owner) {
+   uint8_t buffer[64] = {};
+   std::memcpy(buffer + 12, owner.bytes, sizeof(owner.bytes));
+   return std::bit_cast<evmc::bytes32>(ethash::keccak256(buffer, sizeof(buffer)));
+}
+
+struct bench_options {
+   uint64_t accounts   = 10'000;
+   uint64_t iterations = 100'000;
+   std::vector<std::string> names;
+};
+
+class state_bench {
+public:
+   explicit state_bench(const bench_options& opts) : _opts(opts), _rng(1153), _pick(0, opts.accounts - 1) {
+      const auto start = std::chrono::steady_clock::now();
+
+      _evm.set_account(token_address, 1, 0, evmc::from_hex(token_code).value());
+      _nonces.resize(opts.accounts, 0);
+      for (uint64_t i = 0; i < opts.accounts; ++i) {
+         _evm.set_account(holder(i), 0, intx::uint256{1'000'000} * 1'000'000'000'000'000'000_u256);
+         _evm.set_storage(token_address, balance_slot(holder(i)), word(1'000'000'000));
+      }
+
+      std::cout << "populated " << opts.accounts << " accounts and token balances in "
+                << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s\n";
+   }
+
+   void run(const std::string& name, const std::function<void()>& op) {
+      auto& db = eosio::native::database::instance();
+      const auto before = db.counters;
+      const auto start = std::chrono::steady_clock::now();
+      for (uint64_t i = 0; i < _opts.iterations; ++i) {
+         op();
+      }
+      const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+      const auto& after = db.counters;
+      const double n = double(_opts.iterations);
+
+      std::cout << std::left << std::setw(20) << name
+                << std::right << std::setw(12) << std::fixed << std::setprecision(1) << elapsed / n << " ns/op"
+                << std::setw(10) << std::setprecision(2) << (after.find - before.find) / n << " find"
+                << std::setw(10) << (after.next - before.next) / n << " next"
+                << std::setw(10) << (after.store - before.store) / n << " store"
+                << std::setw(10) << (after.update - before.update) / n << " update"
+                << std::setw(10) << (after.remove - before.remove) / n << " remove\n";
+   }
+
+   void read_account() {
+      run("read_account", [&] {
+         evm_runtime::state state{native_evm::self, native_evm::self, true};
+         auto account = state.read_account(holder(_pick(_rng)));
+         do_not_optimize(account->nonce);
+      });
+   }
+
+   void read_storage() {
+      run("read_storage", [&] {
+         evm_runtime::state state{native_evm::self, native_evm::self, true};
+         auto value = state.read_storage(token_address, 0, balance_slot(holder(_pick(_rng))));
+         do_not_optimize(value.bytes[31]);
+      });
+   }
+
+   void update_storage() {
+      run("update_storage", [&] {
+         evm_runtime::state state{native_evm::self, native_evm::self};
+         const auto key = balance_slot(holder(_pick(_rng)));
+         const auto initial = state.read_storage(token_address, 0, key);
+         state.update_storage(token_address, 0, key, initial, word(intx::be::load<intx::uint256>(initial) + 1));
+      });
+   }
+
+   void erc20_transfer() {
+      run("erc20_transfer", [&] {
+         const uint64_t from = _pick(_rng);
+         silkworm::Bytes data = evmc::from_hex("a9059cbb").value();
+         data += silkworm::ByteView{word(0).bytes, 12};
+         data += silkworm::ByteView{holder(_pick(_rng)).bytes, 20};
+         data += silkworm::ByteView{word(1).bytes, 32};
+
+         auto res = _evm.execute(_evm.make_tx(holder(from), _nonces[from]++, token_address, data, 100'000));
+         eosio::check(res.receipt.success, "token transfer failed");
+         if (++_transfers % 1000 == 0) _evm.next_block();
+      });
+   }
+
+private:
+   template <typename T>
+   static void do_not_optimize(const T& v) {
+      asm volatile("" : : "r,m"(v) : "memory");
+   }
+
+   bench_options                           _opts;
+   native_evm                              _evm;
+   std::mt19937_64                         _rng;
+   std::uniform_int_distribution<uint64_t> _pick;
+   std::vector<uint64_t>                   _nonces;
+   uint64_t                                _transfers = 0;
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+   bench_options opts;
+   for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      if (arg == "--accounts" && i + 1 < argc) {
+         opts.accounts = std::stoull(argv[++i]);
+      } else if (arg == "--iterations" && i + 1 < argc) {
+         opts.iterations = std::stoull(argv[++i]);
+      } else if (arg == "-h" || arg == "--help") {
+         std::cout << "usage: " << argv[0] << " [--accounts N] [--iterations N] "
+                      "[read_account] [read_storage] [update_storage] [erc20_transfer]\n";
+         return 0;
+      } else {
+         opts.names.push_back(arg);
+      }
+   }
+   if (opts.accounts == 0) opts.accounts = 1;
+
+   try {
+      state_bench bench(opts);
+      const std::vector<std::pair<std::string, void (state_bench::*)()>> benches = {
+         {"read_account",   &state_bench::read_account},
+         {"read_storage",   &state_bench::read_storage},
+         {"update_storage", &state_bench::update_storage},
+         {"erc20_transfer", &state_bench::erc20_transfer},
+      };
+      for (const auto& [name, fn] : benches) {
+         if (opts.names.empty() || std::find(opts.names.begin(), opts.names.end(), name) != opts.names.end()) {
+            (bench.*fn)();
+         }
+      }
+   } catch (const std::exception& e) {
+      std::cerr << "error: " << e.what() << "\n";
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <optional>
+#include <utility>
+
+#include <eosio/check.hpp>
+
+namespace eosio {
+
+// Field appended to a table row after rows were already stored, unset on those rows
+template <typename T>
+class binary_extension {
+public:
+   using value_type = T;
+
+   constexpr binary_extension() = default;
+   constexpr binary_extension(const T& v) : _value(v) {}
+   constexpr binary_extension(T&& v) : _value(std::move(v)) {}
+
+   constexpr bool has_value() const { return _value.has_value(); }
+   constexpr explicit operator bool() const { return has_value(); }
+
+   T& value() & {
+      check(has_value(), "cannot get value of empty binary_extension");
+      return *_value;
+   }
+
+   const T& value() const& {
+      check(has_value(), "cannot get value of empty binary_extension");
+      return *_value;
+   }
+
+   template <typename U>
+   T value_or(U&& def) const { return _value.value_or(std::forward<U>(def)); }
+
+   T& operator*() & { return value(); }
+   const T& operator*() const& { return value(); }
+   T* operator->() { return &value(); }
+   const T* operator->() const { return &value(); }
+
+   template <typename... Args>
+   T& emplace(Args&&... args) { return _value.emplace(std::forward<Args>(args)...); }
+
+   void reset() { _value.reset(); }
+
+private:
+   std::optional<T> _value;
+};
+
+} // namespace eosio
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+#include <eosio/fixed_bytes.hpp>
+
+namespace eosio {
+
+checksum160 sha1(const char* data, uint32_t length);
+checksum256 sha256(const char* data, uint32_t length);
+checksum512 sha512(const char* data, uint32_t length);
+checksum160 ripemd160(const char* data, uint32_t length);
+
+} // namespace eosio
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+#include <eosio/crypto.hpp>
+
+namespace eosio {
+
+// Host functions behind the EVM precompiles. sha3 and keccak are computed natively; the others return -1 (error)
+// because their native implementations live in the node, profile them in WASM with the cpu_per_gas benchmarks.
+checksum256 sha3(const char* data, uint32_t length);
+checksum256 keccak(const char* data, uint32_t length);
+
+int32_t k1_recover(const char* sig, uint32_t sig_len, const char* dig, uint32_t dig_len, char* pub, uint32_t pub_len);
+
+int32_t alt_bn128_add(const char* op1, uint32_t op1_len, const char* op2, uint32_t op2_len, char* result, uint32_t result_len);
+int32_t alt_bn128_mul(const char* g1, uint32_t g1_len, const char* scalar, uint32_t scalar_len, char* result, uint32_t result_len);
+int32_t alt_bn128_pair(const char* pairs, uint32_t pairs_len);
+
+int32_t mod_exp(const char* base, uint32_t base_len, const char* exp, uint32_t exp_len, const char* mod, uint32_t mod_len,
+                char* result, uint32_t result_len);
+
+int32_t blake2_f(uint32_t rounds, const char* state, uint32_t state_len, const char* msg, uint32_t msg_len,
+                 const char* t0_offset, uint32_t t0_len, const char* t1_offset, uint32_t t1_len, int32_t final,
+                 char* result, uint32_t result_len);
+
+} // namespace eosio
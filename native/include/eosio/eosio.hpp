@@ -0,0 +1,18 @@
+#pragma once
+
+// Native replacement of the CDT headers used by the state layer, see native/CMakeLists.txt
+
+#include <eosio/asset.hpp>
+#include <eosio/binary_extension.hpp>
+#include <eosio/check.hpp>
+#include <eosio/crypto.hpp>
+#include <eosio/fixed_bytes.hpp>
+#include <eosio/multi_index.hpp>
+#include <eosio/name.hpp>
+#include <eosio/print.hpp>
+#include <eosio/serialize.hpp>
+#include <eosio/singleton.hpp>
+#include <eosio/symbol.hpp>
+#include <eosio/system.hpp>
+#include <eosio/time.hpp>
+#include <eosio/varint.hpp>
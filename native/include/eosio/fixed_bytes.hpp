@@ -0,0 +1,35 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <compare>
+#include <cstdint>
+
+namespace eosio {
+
+// Byte array with the value semantics of the CDT type, ordered lexicographically like the secondary index keys
+template <size_t Size>
+class fixed_bytes {
+public:
+   constexpr fixed_bytes() = default;
+   constexpr fixed_bytes(const std::array<uint8_t, Size>& arr) : _data(arr) {}
+   constexpr fixed_bytes(const uint8_t (&arr)[Size]) { std::copy(arr, arr + Size, _data.begin()); }
+
+   static constexpr size_t size() { return Size; }
+
+   const uint8_t* data() const { return _data.data(); }
+   uint8_t* data() { return _data.data(); }
+
+   std::array<uint8_t, Size> extract_as_byte_array() const { return _data; }
+
+   friend auto operator<=>(const fixed_bytes&, const fixed_bytes&) = default;
+
+private:
+   std::array<uint8_t, Size> _data{};
+};
+
+using checksum160 = fixed_bytes<20>;
+using checksum256 = fixed_bytes<32>;
+using checksum512 = fixed_bytes<64>;
+
+} // namespace eosio
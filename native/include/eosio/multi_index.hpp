@@ -0,0 +1,327 @@
+#pragma once
+
+#include <array>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <set>
+#include <tuple>
+#include <utility>
+
+#include <eosio/check.hpp>
+#include <eosio/name.hpp>
+#include <eosio/native_database.hpp>
+
+namespace eosio {
+
+static constexpr name same_payer{};
+
+template <name::raw IndexName, typename Extractor>
+struct indexed_by {
+   static constexpr name::raw index_name = IndexName;
+   using extractor_type = Extractor;
+};
+
+template <class Class, class Type, Type (Class::*PtrToMemberFunction)() const>
+struct const_mem_fun {
+   using result_type = Type;
+
+   Type operator()(const Class& x) const { return (x.*PtrToMemberFunction)(); }
+};
+
+namespace native {
+
+// Secondary index entry, ordered by (key, primary key) like the chain indexes
+template <typename Key, typename T>
+struct index_entry {
+   Key      key;
+   uint64_t pk;
+   const T* row;
+
+   bool operator<(const index_entry& o) const {
+      if (key < o.key) return true;
+      if (o.key < key) return false;
+      return pk < o.pk;
+   }
+};
+
+template <typename T, typename... Indices>
+struct table_storage {
+   std::map<uint64_t, std::unique_ptr<T>>                                           rows;
+   std::tuple<std::set<index_entry<typename Indices::extractor_type::result_type, T>>...> indexes;
+};
+
+} // namespace native
+
+// In-memory multi_index with the interface of the CDT one. Rows keep their address until they are erased, which is
+// what the contract relies on when it holds references to rows across calls.
+template <name::raw TableName, typename T, typename... Indices>
+class multi_index {
+   using storage_type = native::table_storage<T, Indices...>;
+   using row_map      = std::map<uint64_t, std::unique_ptr<T>>;
+
+public:
+   class const_iterator {
+   public:
+      using iterator_category = std::bidirectional_iterator_tag;
+      using value_type        = const T;
+      using difference_type   = std::ptrdiff_t;
+      using pointer           = const T*;
+      using reference         = const T&;
+
+      const_iterator() = default;
+
+      const T& operator*() const { return *_itr->second; }
+      const T* operator->() const { return _itr->second.get(); }
+
+      const_iterator& operator++() { ++native::database::instance().counters.next; ++_itr; return *this; }
+      const_iterator& operator--() { ++native::database::instance().counters.next; --_itr; return *this; }
+      const_iterator operator++(int) { auto res = *this; ++*this; return res; }
+      const_iterator operator--(int) { auto res = *this; --*this; return res; }
+
+      bool operator==(const const_iterator& o) const { return _itr == o._itr; }
+      bool operator!=(const const_iterator& o) const { return _itr != o._itr; }
+
+   private:
+      friend class multi_index;
+      explicit const_iterator(typename row_map::const_iterator itr) : _itr(itr) {}
+
+      typename row_map::const_iterator _itr;
+   };
+
+   using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+   template <size_t I>
+   class index {
+      using indexed_type = std::tuple_element_t<I, std::tuple<Indices...>>;
+      using key_type     = typename indexed_type::extractor_type::result_type;
+      using entry_type   = native::index_entry<key_type, T>;
+      using set_type     = std::set<entry_type>;
+
+   public:
+      class const_iterator {
+      public:
+         using iterator_category = std::bidirectional_iterator_tag;
+         using value_type        = const T;
+         using difference_type   = std::ptrdiff_t;
+         using pointer           = const T*;
+         using reference         = const T&;
+
+         const_iterator() = default;
+
+         const T& operator*() const { return *_itr->row; }
+         const T* operator->() const { return _itr->row; }
+
+         const_iterator& operator++() { ++native::database::instance().counters.next; ++_itr; return *this; }
+         const_iterator& operator--() { ++native::database::instance().counters.next; --_itr; return *this; }
+         const_iterator operator++(int) { auto res = *this; ++*this; return res; }
+         const_iterator operator--(int) { auto res = *this; --*this; return res; }
+
+         bool operator==(const const_iterator& o) const { return _itr == o._itr; }
+         bool operator!=(const const_iterator& o) const { return _itr != o._itr; }
+
+      private:
+         friend class index;
+         explicit const_iterator(typename set_type::const_iterator itr) : _itr(itr) {}
+
+         typename set_type::const_iterator _itr;
+      };
+
+      using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+      explicit index(const multi_index* mi) : _mi(mi) {}
+
+      const_iterator begin() const { return const_iterator(entries().begin()); }
+      const_iterator end() const { return const_iterator(entries().end()); }
+      const_iterator cbegin() const { return begin(); }
+      const_iterator cend() const { return end(); }
+      const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+      const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+      const_iterator find(const key_type& key) const {
+         ++native::database::instance().counters.find;
+         auto itr = entries().lower_bound(entry_type{key, 0, nullptr});
+         if (itr == entries().end() || key < itr->key || itr->key < key) return end();
+         return const_iterator(itr);
+      }
+
+      const_iterator require_find(const key_type& key, const char* error_msg = "unable to find secondary key") const {
+         auto itr = find(key);
+         check(itr != end(), error_msg);
+         return itr;
+      }
+
+      const T& get(const key_type& key, const char* error_msg = "unable to find secondary key") const {
+         return *require_find(key, error_msg);
+      }
+
+      const_iterator lower_bound(const key_type& key) const {
+         ++native::database::instance().counters.next;
+         return const_iterator(entries().lower_bound(entry_type{key, 0, nullptr}));
+      }
+
+      const_iterator upper_bound(const key_type& key) const {
+         ++native::database::instance().counters.next;
+         return const_iterator(entries().upper_bound(entry_type{key, std::numeric_limits<uint64_t>::max(), nullptr}));
+      }
+
+      const_iterator iterator_to(const T& obj) const {
+         return const_iterator(entries().find(entry_type{extractor(obj), obj.primary_key(), &obj}));
+      }
+
+      template <typename Lambda>
+      void modify(const_iterator itr, name payer, Lambda&& updater) const {
+         check(itr != end(), "cannot pass end iterator to modify");
+         const_cast<multi_index*>(_mi)->modify(*itr, payer, std::forward<Lambda>(updater));
+      }
+
+      const_iterator erase(const_iterator itr) const {
+         check(itr != end(), "cannot pass end iterator to erase");
+         const T& obj = *itr;
+         ++itr;
+         const_cast<multi_index*>(_mi)->erase(obj);
+         return itr;
+      }
+
+      static key_type extractor(const T& obj) { return typename indexed_type::extractor_type{}(obj); }
+
+   private:
+      const set_type& entries() const { return std::get<I>(_mi->_storage->indexes); }
+
+      const multi_index* _mi;
+   };
+
+   multi_index(name code, uint64_t scope)
+      : _code(code), _scope(scope),
+        _storage(&native::database::instance().template get<storage_type>(code.value, scope, static_cast<uint64_t>(TableName))) {}
+
+   name get_code() const { return _code; }
+   uint64_t get_scope() const { return _scope; }
+
+   const_iterator begin() const { return const_iterator(rows().begin()); }
+   const_iterator end() const { return const_iterator(rows().end()); }
+   const_iterator cbegin() const { return begin(); }
+   const_iterator cend() const { return end(); }
+   const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+   const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+   const_iterator find(uint64_t primary) const {
+      ++native::database::instance().counters.find;
+      return const_iterator(rows().find(primary));
+   }
+
+   const_iterator require_find(uint64_t primary, const char* error_msg = "unable to find key") const {
+      auto itr = find(primary);
+      check(itr != end(), error_msg);
+      return itr;
+   }
+
+   const T& get(uint64_t primary, const char* error_msg = "unable to find key") const {
+      return *require_find(primary, error_msg);
+   }
+
+   const_iterator lower_bound(uint64_t primary) const {
+      ++native::database::instance().counters.next;
+      return const_iterator(rows().lower_bound(primary));
+   }
+
+   const_iterator upper_bound(uint64_t primary) const {
+      ++native::database::instance().counters.next;
+      return const_iterator(rows().upper_bound(primary));
+   }
+
+   const_iterator iterator_to(const T& obj) const { return const_iterator(rows().find(obj.primary_key())); }
+
+   uint64_t available_primary_key() const {
+      if (rows().empty()) return 0;
+      const uint64_t last = rows().rbegin()->first;
+      check(last < std::numeric_limits<uint64_t>::max() - 1, "next primary key in table is at autoincrement limit");
+      return last + 1;
+   }
+
+   template <name::raw IndexName>
+   auto get_index() const {
+      constexpr size_t position = index_position<IndexName>();
+      static_assert(position < sizeof...(Indices), "name provided is not the name of any secondary index within multi_index");
+      return index<position>(this);
+   }
+
+   template <typename Lambda>
+   const_iterator emplace(name payer, Lambda&& constructor) {
+      check(payer.value != 0, "cannot set payer to the empty name when emplacing");
+      auto row = std::make_unique<T>();
+      constructor(*row);
+      const uint64_t pk = row->primary_key();
+      check(!rows().count(pk), "could not insert object, most likely a uniqueness constraint was violated");
+      add_to_indexes(*row, std::index_sequence_for<Indices...>{});
+      ++native::database::instance().counters.store;
+      return const_iterator(_storage->rows.emplace(pk, std::move(row)).first);
+   }
+
+   template <typename Lambda>
+   void modify(const_iterator itr, name payer, Lambda&& updater) {
+      check(itr != end(), "cannot pass end iterator to modify");
+      modify(*itr, payer, std::forward<Lambda>(updater));
+   }
+
+   template <typename Lambda>
+   void modify(const T& obj, name, Lambda&& updater) {
+      T& row = mutable_row(obj, "object passed to modify is not in multi_index");
+      const uint64_t pk = row.primary_key();
+      remove_from_indexes(row, std::index_sequence_for<Indices...>{});
+      updater(row);
+      check(pk == row.primary_key(), "updater cannot change primary key when modifying an object");
+      add_to_indexes(row, std::index_sequence_for<Indices...>{});
+      ++native::database::instance().counters.update;
+   }
+
+   const_iterator erase(const_iterator itr) {
+      check(itr != end(), "cannot pass end iterator to erase");
+      const T& obj = *itr;
+      ++itr;
+      erase(obj);
+      return itr;
+   }
+
+   void erase(const T& obj) {
+      T& row = mutable_row(obj, "object passed to erase is not in multi_index");
+      remove_from_indexes(row, std::index_sequence_for<Indices...>{});
+      _storage->rows.erase(row.primary_key());
+      ++native::database::instance().counters.remove;
+   }
+
+private:
+   template <name::raw IndexName>
+   static constexpr size_t index_position() {
+      constexpr std::array<name::raw, sizeof...(Indices)> names{Indices::index_name...};
+      for (size_t i = 0; i < names.size(); ++i) {
+         if (names[i] == IndexName) return i;
+      }
+      return sizeof...(Indices);
+   }
+
+   const row_map& rows() const { return _storage->rows; }
+
+   T& mutable_row(const T& obj, const char* error_msg) {
+      auto itr = _storage->rows.find(obj.primary_key());
+      check(itr != _storage->rows.end() && itr->second.get() == &obj, error_msg);
+      return *itr->second;
+   }
+
+   template <size_t... I>
+   void add_to_indexes(const T& row, std::index_sequence<I...>) {
+      (std::get<I>(_storage->indexes).insert({index<I>::extractor(row), row.primary_key(), &row}), ...);
+   }
+
+   template <size_t... I>
+   void remove_from_indexes(const T& row, std::index_sequence<I...>) {
+      (std::get<I>(_storage->indexes).erase({index<I>::extractor(row), row.primary_key(), &row}), ...);
+   }
+
+   name          _code;
+   uint64_t      _scope;
+   storage_type* _storage;
+};
+
+} // namespace eosio
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <eosio/check.hpp>
+
+namespace eosio {
+
+struct name {
+   enum class raw : uint64_t {};
+
+   constexpr name() : value(0) {}
+   constexpr explicit name(uint64_t v) : value(v) {}
+   constexpr explicit name(raw r) : value(static_cast<uint64_t>(r)) {}
+
+   constexpr explicit name(std::string_view str) : value(0) {
+      if (str.size() > 13) throw eosio_assert_exception("string is too long to be a valid name");
+      const auto n = str.size() < 12 ? str.size() : 12;
+      for (size_t i = 0; i < n; ++i) {
+         value <<= 5;
+         value |= char_to_value(str[i]);
+      }
+      value <<= (4 + 5 * (12 - n));
+      if (str.size() == 13) {
+         const uint64_t v = char_to_value(str[12]);
+         if (v > 0x0f) throw eosio_assert_exception("thirteenth character in name cannot be a letter that comes after j");
+         value |= v;
+      }
+   }
+
+   static constexpr uint8_t char_to_value(char c) {
+      if (c == '.') return 0;
+      if (c >= '1' && c <= '5') return (c - '1') + 1;
+      if (c >= 'a' && c <= 'z') return (c - 'a') + 6;
+      throw eosio_assert_exception("character is not in allowed character set for names");
+   }
+
+   std::string to_string() const {
+      static constexpr char charmap[] = ".12345abcdefghijklmnopqrstuvwxyz";
+      std::string str(13, '.');
+      uint64_t tmp = value;
+      for (uint32_t i = 0; i <= 12; ++i) {
+         str[12 - i] = charmap[tmp & (i == 0 ? 0x0f : 0x1f)];
+         tmp >>= (i == 0 ? 4 : 5);
+      }
+      str.erase(str.find_last_not_of('.') + 1);
+      return str;
+   }
+
+   constexpr operator raw() const { return raw(value); }
+   constexpr explicit operator bool() const { return value != 0; }
+
+   friend constexpr bool operator==(const name& a, const name& b) { return a.value == b.value; }
+   friend constexpr bool operator!=(const name& a, const name& b) { return a.value != b.value; }
+   friend constexpr bool operator<(const name& a, const name& b) { return a.value < b.value; }
+
+   uint64_t value = 0;
+};
+
+} // namespace eosio
+
+inline constexpr eosio::name operator""_n(const char* s, std::size_t n) {
+   return eosio::name{std::string_view{s, n}};
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <tuple>
+
+namespace eosio::native {
+
+// Number of database operations, the natively profiled counterpart of the db_*_i64 / db_idx*_ host functions
+struct db_counters {
+   uint64_t find   = 0;
+   uint64_t next   = 0; // <- lower_bound/upper_bound
+   uint64_t store  = 0;
+   uint64_t update = 0;
+   uint64_t remove = 0;
+};
+
+// In-memory replacement of the chain database. Every (code, scope, table) gets its own table, created on first use,
+// and lives until clear() is called.
+class database {
+public:
+   static database& instance() {
+      static database db;
+      return db;
+   }
+
+   template <typename Table>
+   Table& get(uint64_t code, uint64_t scope, uint64_t table) {
+      auto& slot = _tables[{code, scope, table}];
+      if (!slot) slot = std::make_shared<Table>();
+      return *static_cast<Table*>(slot.get());
+   }
+
+   void clear() {
+      _tables.clear();
+      counters = {};
+   }
+
+   size_t table_count() const { return _tables.size(); }
+
+   db_counters counters;
+
+private:
+   std::map<std::tuple<uint64_t, uint64_t, uint64_t>, std::shared_ptr<void>> _tables;
+};
+
+} // namespace eosio::native
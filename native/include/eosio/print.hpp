@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include <eosio/name.hpp>
+
+namespace eosio {
+
+inline void print_one(const char* s) { std::cout << s; }
+inline void print_one(std::string_view s) { std::cout << s; }
+inline void print_one(const std::string& s) { std::cout << s; }
+inline void print_one(name n) { std::cout << n.to_string(); }
+inline void print_one(bool b) { std::cout << (b ? "true" : "false"); }
+
+template <typename T>
+inline void print_one(const T& v) { std::cout << +v; }
+
+template <typename... Args>
+inline void print(Args&&... args) {
+   (print_one(std::forward<Args>(args)), ...);
+}
+
+template <typename... Args>
+inline void print_f(const char* s, Args&&... args) {
+   // % placeholders are not expanded natively, print the arguments after the format string
+   std::cout << s;
+   (print_one(std::forward<Args>(args)), ...);
+}
+
+inline void printhex(const void* data, uint32_t datalen) {
+   const auto* p = static_cast<const uint8_t*>(data);
+   for (uint32_t i = 0; i < datalen; ++i) std::printf("%02x", p[i]);
+   std::fflush(stdout);
+}
+
+} // namespace eosio
@@ -0,0 +1,5 @@
+#pragma once
+
+// Rows live unpacked in the native database, nothing gets serialized
+#define EOSLIB_SERIALIZE(TYPE, MEMBERS)
+#define EOSLIB_SERIALIZE_DERIVED(TYPE, BASE, MEMBERS)
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <optional>
+
+#include <eosio/check.hpp>
+#include <eosio/name.hpp>
+#include <eosio/native_database.hpp>
+
+namespace eosio {
+
+template <name::raw SingletonName, typename T>
+class singleton {
+   using storage_type = std::optional<T>;
+
+public:
+   singleton(name code, uint64_t scope)
+      : _storage(&native::database::instance().template get<storage_type>(code.value, scope, static_cast<uint64_t>(SingletonName))) {}
+
+   bool exists() const {
+      ++native::database::instance().counters.find;
+      return _storage->has_value();
+   }
+
+   T get() const {
+      check(exists(), "singleton does not exist");
+      return **_storage;
+   }
+
+   T get_or_default(const T& def = T()) const { return exists() ? **_storage : def; }
+
+   T get_or_create(name bill_to_account, const T& def = T()) {
+      if (!exists()) set(def, bill_to_account);
+      return **_storage;
+   }
+
+   void set(const T& value, name) {
+      auto& counters = native::database::instance().counters;
+      ++(_storage->has_value() ? counters.update : counters.store);
+      *_storage = value;
+   }
+
+   void remove() {
+      if (_storage->has_value()) ++native::database::instance().counters.remove;
+      _storage->reset();
+   }
+
+private:
+   storage_type* _storage;
+};
+
+} // namespace eosio
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <eosio/check.hpp>
+
+namespace eosio {
+
+class symbol_code {
+public:
+   constexpr symbol_code() : value(0) {}
+   constexpr explicit symbol_code(uint64_t raw) : value(raw) {}
+   constexpr explicit symbol_code(std::string_view str) : value(0) {
+      if (str.size() > 7) throw eosio_assert_exception("string is too long to be a valid symbol_code");
+      for (auto itr = str.rbegin(); itr != str.rend(); ++itr) {
+         if (*itr < 'A' || *itr > 'Z') throw eosio_assert_exception("only uppercase letters allowed in symbol_code string");
+         value <<= 8;
+         value |= *itr;
+      }
+   }
+
+   constexpr uint64_t raw() const { return value; }
+
+   std::string to_string() const {
+      std::string res;
+      for (uint64_t v = value; v; v >>= 8) res += char(v & 0xff);
+      return res;
+   }
+
+   friend constexpr bool operator==(const symbol_code& a, const symbol_code& b) { return a.value == b.value; }
+   friend constexpr bool operator!=(const symbol_code& a, const symbol_code& b) { return a.value != b.value; }
+   friend constexpr bool operator<(const symbol_code& a, const symbol_code& b) { return a.value < b.value; }
+
+private:
+   uint64_t value;
+};
+
+class symbol {
+public:
+   constexpr symbol() : value(0) {}
+   constexpr explicit symbol(uint64_t s) : value(s) {}
+   constexpr symbol(symbol_code sc, uint8_t precision) : value((sc.raw() << 8) | precision) {}
+   constexpr symbol(std::string_view ss, uint8_t precision) : value((symbol_code(ss).raw() << 8) | precision) {}
+
+   constexpr bool is_valid() const { return value != 0; }
+   constexpr uint8_t precision() const { return value & 0xff; }
+   constexpr symbol_code code() const { return symbol_code(value >> 8); }
+   constexpr uint64_t raw() const { return value; }
+
+   friend constexpr bool operator==(const symbol& a, const symbol& b) { return a.value == b.value; }
+   friend constexpr bool operator!=(const symbol& a, const symbol& b) { return a.value != b.value; }
+   friend constexpr bool operator<(const symbol& a, const symbol& b) { return a.value < b.value; }
+
+private:
+   uint64_t value;
+};
+
+} // namespace eosio
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <eosio/name.hpp>
+#include <eosio/time.hpp>
+
+namespace eosio {
+
+// Native builds run a single contract, self and the sender of the current action are set by the harness
+name current_receiver();
+name get_sender();
+
+namespace native {
+   void set_current_receiver(name receiver);
+   void set_sender(name sender);
+}
+
+} // namespace eosio
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+
+namespace eosio {
+
+class microseconds {
+public:
+   constexpr explicit microseconds(int64_t c = 0) : _count(c) {}
+
+   constexpr int64_t count() const { return _count; }
+   constexpr int64_t to_seconds() const { return _count / 1'000'000; }
+
+   constexpr microseconds operator+(const microseconds& o) const { return microseconds(_count + o._count); }
+   constexpr microseconds operator-(const microseconds& o) const { return microseconds(_count - o._count); }
+   constexpr microseconds& operator+=(const microseconds& o) { _count += o._count; return *this; }
+   constexpr microseconds& operator-=(const microseconds& o) { _count -= o._count; return *this; }
+
+   friend constexpr auto operator<=>(const microseconds&, const microseconds&) = default;
+
+private:
+   int64_t _count;
+};
+
+constexpr microseconds seconds(int64_t s) { return microseconds(s * 1'000'000); }
+constexpr microseconds milliseconds(int64_t s) { return microseconds(s * 1'000); }
+constexpr microseconds minutes(int64_t m) { return seconds(60 * m); }
+constexpr microseconds hours(int64_t h) { return minutes(60 * h); }
+constexpr microseconds days(int64_t d) { return hours(24 * d); }
+
+class time_point {
+public:
+   constexpr explicit time_point(microseconds e = microseconds()) : elapsed(e) {}
+
+   constexpr const microseconds& time_since_epoch() const { return elapsed; }
+   constexpr uint32_t sec_since_epoch() const { return uint32_t(elapsed.count() / 1'000'000); }
+
+   constexpr time_point operator+(const microseconds& m) const { return time_point(elapsed + m); }
+   constexpr time_point operator-(const microseconds& m) const { return time_point(elapsed - m); }
+   constexpr microseconds operator-(const time_point& m) const { return elapsed - m.elapsed; }
+   constexpr time_point& operator+=(const microseconds& m) { elapsed += m; return *this; }
+
+   friend constexpr auto operator<=>(const time_point&, const time_point&) = default;
+
+   microseconds elapsed;
+};
+
+class time_point_sec {
+public:
+   constexpr time_point_sec() : utc_seconds(0) {}
+   constexpr explicit time_point_sec(uint32_t seconds) : utc_seconds(seconds) {}
+   constexpr time_point_sec(const time_point& t) : utc_seconds(t.sec_since_epoch()) {}
+
+   static constexpr time_point_sec maximum() { return time_point_sec(0xffffffff); }
+   static constexpr time_point_sec min() { return time_point_sec(0); }
+
+   constexpr operator time_point() const { return time_point(seconds(utc_seconds)); }
+   constexpr uint32_t sec_since_epoch() const { return utc_seconds; }
+
+   constexpr time_point_sec operator+(uint32_t offset) const { return time_point_sec(utc_seconds + offset); }
+   constexpr time_point_sec operator-(uint32_t offset) const { return time_point_sec(utc_seconds - offset); }
+
+   friend constexpr auto operator<=>(const time_point_sec&, const time_point_sec&) = default;
+
+   uint32_t utc_seconds;
+};
+
+// Native builds read the time set by the harness, see eosio::native::set_current_time
+time_point current_time_point();
+
+namespace native {
+   void set_current_time(time_point t);
+}
+
+} // namespace eosio
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+namespace eosio {
+
+struct unsigned_int {
+   constexpr unsigned_int(uint32_t v = 0) : value(v) {}
+   constexpr operator uint32_t() const { return value; }
+
+   uint32_t value;
+};
+
+struct signed_int {
+   constexpr signed_int(int32_t v = 0) : value(v) {}
+   constexpr operator int32_t() const { return value; }
+
+   int32_t value;
+};
+
+} // namespace eosio
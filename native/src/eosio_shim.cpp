@@ -0,0 +1,62 @@
+#include <cstring>
+
+#include <openssl/evp.h>
+
+#include <ethash/keccak.hpp>
+
+#include <eosio/crypto_ext.hpp>
+#include <eosio/system.hpp>
+
+namespace eosio {
+
+namespace {
+   time_point current_time;
+   name receiver;
+   name sender;
+
+   template <size_t Size>
+   fixed_bytes<Size> digest(const EVP_MD* md, const char* data, uint32_t length) {
+      uint8_t out[EVP_MAX_MD_SIZE];
+      unsigned int out_len = 0;
+      check(EVP_Digest(data, length, out, &out_len, md, nullptr) == 1 && out_len == Size, "digest failed");
+      std::array<uint8_t, Size> res;
+      std::memcpy(res.data(), out, Size);
+      return res;
+   }
+}
+
+time_point current_time_point() { return current_time; }
+name current_receiver() { return receiver; }
+name get_sender() { return sender; }
+
+namespace native {
+   void set_current_time(time_point t) { current_time = t; }
+   void set_current_receiver(name r) { receiver = r; }
+   void set_sender(name s) { sender = s; }
+}
+
+checksum160 sha1(const char* data, uint32_t length) { return digest<20>(EVP_sha1(), data, length); }
+checksum256 sha256(const char* data, uint32_t length) { return digest<32>(EVP_sha256(), data, length); }
+checksum512 sha512(const char* data, uint32_t length) { return digest<64>(EVP_sha512(), data, length); }
+checksum160 ripemd160(const char* data, uint32_t length) { return digest<20>(EVP_ripemd160(), data, length); }
+checksum256 sha3(const char* data, uint32_t length) { return digest<32>(EVP_sha3_256(), data, length); }
+
+checksum256 keccak(const char* data, uint32_t length) {
+   const auto h = ethash::keccak256(reinterpret_cast<const uint8_t*>(data), length);
+   return h.bytes;
+}
+
+int32_t k1_recover(const char*, uint32_t, const char*, uint32_t, char*, uint32_t) { return -1; }
+
+int32_t alt_bn128_add(const char*, uint32_t, const char*, uint32_t, char*, uint32_t) { return -1; }
+int32_t alt_bn128_mul(const char*, uint32_t, const char*, uint32_t, char*, uint32_t) { return -1; }
+int32_t alt_bn128_pair(const char*, uint32_t) { return -1; }
+
+int32_t mod_exp(const char*, uint32_t, const char*, uint32_t, const char*, uint32_t, char*, uint32_t) { return -1; }
+
+int32_t blake2_f(uint32_t, const char*, uint32_t, const char*, uint32_t, const char*, uint32_t, const char*, uint32_t,
+                 int32_t, char*, uint32_t) {
+   return -1;
+}
+
+} // namespace eosio
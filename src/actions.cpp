@@ -9,6 +9,9 @@
 #include <evm_runtime/eosio.token.hpp>
 #include <evm_runtime/bridge.hpp>
 #include <evm_runtime/config_wrapper.hpp>
+#ifdef WITH_MEMORY_STATS
+#include <evm_runtime/memory_stats.hpp>
+#endif
 
 #include <silkworm/core/protocol/trust_rule_set.hpp>
 // included here so NDEBUG is defined to disable assert macro
@@ -37,8 +40,50 @@ static constexpr char err_msg_invalid_addr[] = "invalid address";
 
 using namespace silkworm;
 
+namespace {
+
+template <typename T, typename Variant, size_t I = 0>
+constexpr uint32_t variant_index() {
+    if constexpr (std::is_same_v<std::variant_alternative_t<I, Variant>, T>) {
+        return I;
+    } else {
+        return variant_index<T, Variant, I + 1>();
+    }
+}
+
+// Send an evmtx event packed straight from the rlp view, the layout is the one of evmtx_type{Event{...}}
+template <typename Event, typename... Fields>
+void send_evmtx(eosio::name self, uint64_t eos_evm_version, ByteView rlptx, const Fields&... fields) {
+    const eosio::unsigned_int index = variant_index<Event, evmtx_type>();
+    const eosio::unsigned_int rlptx_size = rlptx.size();
+
+    eosio::action act;
+    act.account = self;
+    act.name = "evmtx"_n;
+    act.data.resize(eosio::pack_size(index) + sizeof(eos_evm_version) + eosio::pack_size(rlptx_size) + rlptx.size() + (eosio::pack_size(fields) + ... + 0));
+    eosio::datastream<char*> ds(act.data.data(), act.data.size());
+    ds << index << eos_evm_version << rlptx_size;
+    ds.write((const char*)rlptx.data(), rlptx.size());
+    (ds << ... << fields);
+    act.send();
+}
+
+} // namespace
+
 evm_contract::evm_contract(eosio::name receiver, eosio::name code, const datastream<const char*>& ds) : 
-        contract(receiver, code, ds), _config(std::make_shared<config_wrapper>(get_self())) {}
+        contract(receiver, code, ds), _config(std::make_shared<config_wrapper>(get_self())) {
+#ifdef WITH_MEMORY_STATS
+    memory_stats::begin();
+#endif
+}
+
+evm_contract::~evm_contract() {
+    flush_block_gas(); // <- may fold fee income into the statistics
+    flush_statistics();
+#ifdef WITH_MEMORY_STATS
+    memory_stats::print();
+#endif
+}
 
 void evm_contract::assert_inited()
 {
@@ -79,8 +124,18 @@ void evm_contract::init(const uint64_t chainid, const fee_parameters& fee_params
       .balance = eosio::asset(0, fee_params.ingress_bridge_fee->symbol),
       .dust = 0
    });
-
-   open_internal_balance(get_self());
+   // The state digest is maintained from genesis on, contracts initialized before it existed build it with seeddigest
+   state_digest_singleton(get_self(), get_self().value).set(state_digest{.digest = bytes(32, 0)}, get_self());
+
+   // The contract's own nonce starts out in nextnonces, where contracts predating migratenonce look for it, and
+   // moves into the balances row the first time it is used.
+   balances(get_self(), get_self().value).emplace(get_self(), [&](balance& a) {
+      a.owner = get_self();
+      a.balance.balance = eosio::asset(0, _config->get_token_symbol());
+   });
+   nextnonces(get_self(), get_self().value).emplace(get_self(), [&](nextnonce& a) {
+      a.owner = get_self();
+   });
 }
 
 void evm_contract::setfeeparams(const fee_parameters& fee_params)
@@ -318,8 +373,23 @@ Receipt evm_contract::execute_tx(const runtime_config& rc, eosio::name miner, Bl
 
         intx::uint256 minimum_natively_representable = intx::uint256(_config->get_minimum_natively_representable());
 
+        const auto& filtered_messages = ep.state().filtered_messages();
         std::vector<bool> need_send;
-        need_send.resize(ep.state().filtered_messages().size(), false);
+        need_send.resize(filtered_messages.size(), false);
+
+        // Index the filtered messages by receiver once, so each non-open egress target only visits its own messages.
+        std::optional<std::map<evmc::address, std::vector<size_t>>> messages_by_receiver;
+        auto get_messages_for = [&](const evmc::address& receiver) -> const std::vector<size_t>& {
+            static const std::vector<size_t> empty;
+            if (!messages_by_receiver) {
+                messages_by_receiver.emplace();
+                for (size_t i = 0; i < filtered_messages.size(); ++i) {
+                    (*messages_by_receiver)[filtered_messages[i].receiver].push_back(i);
+                }
+            }
+            auto it = messages_by_receiver->find(receiver);
+            return it != messages_by_receiver->end() ? it->second : empty;
+        };
 
         for(const auto& reserved_object : ep.state().reserved_objects()) {
             const evmc::address& address = reserved_object.first;
@@ -334,7 +404,7 @@ Receipt evm_contract::execute_tx(const runtime_config& rc, eosio::name miner, Bl
             total_egress += reserved_account.balance;
 
             if(auto it = balance_table.find(egress_account.value); it != balance_table.end()) {
-                balance_table.modify(balance_table.get(egress_account.value), eosio::same_payer, [&](balance& b){
+                balance_table.modify(*it, eosio::same_payer, [&](balance& b){
                     b.balance += reserved_account.balance;
                     if (gas_fee_miner_portion.has_value() && egress_account == get_self()) {
                         check(!deducted_miner_cut, "unexpected error: contract account appears twice in reserved objects");
@@ -347,24 +417,22 @@ Receipt evm_contract::execute_tx(const runtime_config& rc, eosio::name miner, Bl
                 // check(!non_open_account_sent, "only one non-open account for egress bridging allowed in single transaction");
                 // Assert not transfer to self
                 check(egress_account != get_self(), "evm runtime account not open");
-                check(is_account(egress_account), "can only egress bridge to existing accounts");
-                if(get_code_hash(egress_account) != checksum256())
-                    egresslist(get_self(), get_self().value).get(egress_account.value, "non-open accounts containing contract code must be on allow list for egress bridging");
+                const auto& props = get_egress_account_properties(egress_account);
+                check(props.is_account, "can only egress bridge to existing accounts");
+                check(!props.has_code || props.on_allow_list, "non-open accounts containing contract code must be on allow list for egress bridging");
 
                 auto balance = reserved_account.balance;
                 uint64_t pending_transfer = 0;
-                for (size_t i = 0; i < ep.state().filtered_messages().size(); ++i) {      
-                    const auto& rawmsg = ep.state().filtered_messages()[i];
-                    if (rawmsg.receiver == address) {
-                        check(++pending_transfer <= 5, "only five transfers to each non-open account allowed in single transaction");
-                        auto value = intx::be::unsafe::load<uint256>(rawmsg.value.bytes);
-                        check(value % minimum_natively_representable == 0_u256, "egress bridging to non-open accounts must not contain dust");
-                        check(balance >= value, "sum of bridge transfers not match total received balance");
-                        balance -= value;
-
-                        // Only record action here so that we can launch transfers in order later.
-                        need_send[i] = true;
-                    }
+                for (size_t i : get_messages_for(address)) {
+                    const auto& rawmsg = filtered_messages[i];
+                    check(++pending_transfer <= 5, "only five transfers to each non-open account allowed in single transaction");
+                    auto value = intx::be::unsafe::load<uint256>(rawmsg.value.bytes);
+                    check(value % minimum_natively_representable == 0_u256, "egress bridging to non-open accounts must not contain dust");
+                    check(balance >= value, "sum of bridge transfers not match total received balance");
+                    balance -= value;
+
+                    // Only record action here so that we can launch transfers in order later.
+                    need_send[i] = true;
                 }
 
                 check(balance == 0_u256, "sum of bridge transfers not match total received balance");
@@ -373,12 +441,12 @@ Receipt evm_contract::execute_tx(const runtime_config& rc, eosio::name miner, Bl
         }
 
         // Keep the transfer order.
-        for (size_t i = 0; i < ep.state().filtered_messages().size(); ++i) {
+        for (size_t i = 0; i < filtered_messages.size(); ++i) {
             if (!need_send[i]) {
                 continue;
             }
 
-            const auto& rawmsg = ep.state().filtered_messages()[i];
+            const auto& rawmsg = filtered_messages[i];
             const name egress_account(*extract_reserved_address(rawmsg.receiver));
             auto value = intx::be::unsafe::load<uint256>(rawmsg.value.bytes);
             token::transfer_bytes_memo_action transfer_act(_config->get_token_contract(), {{get_self(), "active"_n}});
@@ -422,20 +490,18 @@ Receipt evm_contract::execute_tx(const runtime_config& rc, eosio::name miner, Bl
         // Gas income from tx sent from self should not be counted.
         // Bridge transfers can generate such txs.
         uint64_t tx_gas_used = receipt.cumulative_gas_used; // Only transaction in the "block" so cumulative_gas_used is the tx gas_used.
-        auto s = get_statistics();
         if (_config->get_evm_version() >= 1) {
             intx::uint512 gas_fee = intx::uint256(tx_gas_used) * ep.evm().block().header.base_fee_per_gas.value();
             check(gas_fee < std::numeric_limits<intx::uint256>::max(), "too much gas");
-            s.gas_fee_income += static_cast<intx::uint256>(gas_fee);
+            add_gas_fee_income(static_cast<intx::uint256>(gas_fee));
         } else {
             intx::uint512 gas_fee = intx::uint256(tx_gas_used) * tx.max_fee_per_gas;
             check(gas_fee < std::numeric_limits<intx::uint256>::max(), "too much gas");
             if (gas_fee_miner_portion.has_value()) {
                 gas_fee -= *gas_fee_miner_portion;
             } 
-            s.gas_fee_income += static_cast<intx::uint256>(gas_fee);
+            add_gas_fee_income(static_cast<intx::uint256>(gas_fee));
         }
-        set_statistics(s);
     }
 
     LOGTIME("EVM EXECUTE");
@@ -505,6 +571,31 @@ void evm_contract::exec(const exec_input& input, const std::optional<exec_callba
 
 void evm_contract::process_filtered_messages(std::function<bool(const silkworm::FilteredMessage&)> extra_filter, const std::vector<silkworm::FilteredMessage>& filtered_messages ) {
 
+    // Registered receivers are looked up once per transaction.
+    struct receiver_state {
+        eosio::name           handler;
+        uint32_t              flags = 0;
+        intx::uint256         min_fee;
+        intx::uint256         value;
+        std::optional<size_t> batch; // index into deliveries of the batch for this receiver
+    };
+    std::map<uint64_t, receiver_state> receivers;
+
+    // Messages are delivered in the order they were emitted. A receiver that opted into batch delivery gets all of
+    // its messages in a single onbridgemsgs action sent at the position of its first message.
+    struct delivery {
+        eosio::name                 handler;
+        bool                        batched = false;
+        std::vector<bridge_message> messages;
+    };
+    std::vector<delivery> deliveries;
+
+    // Non-atomic messages to receivers that opted into async delivery are queued instead (see pullmsgs).
+    std::map<uint64_t, message_queue_table> queues;
+
+    const intx::uint256 minimum_natively_representable = intx::uint256(_config->get_minimum_natively_representable());
+    std::optional<message_receiver_table> message_receivers;
+
     intx::uint256 accumulated_value;
     for(const auto& rawmsg : filtered_messages) {
         if (!(extra_filter)(rawmsg)) {
@@ -517,42 +608,85 @@ void evm_contract::process_filtered_messages(std::function<bool(const silkworm::
         auto& msg_v0 = std::get<bridge::message_v0>(msg.value());
 
         const auto& receiver = msg_v0.get_account_as_name();
-        eosio::check(eosio::is_account(receiver), "receiver is not account");
 
-        message_receiver_table message_receivers(get_self(), get_self().value);
-        auto it = message_receivers.find(receiver.value);
-        eosio::check(it != message_receivers.end(), "receiver not registered");
+        auto rit = receivers.find(receiver.value);
+        if (rit == receivers.end()) {
+            eosio::check(eosio::is_account(receiver), "receiver is not account");
 
-        eosio::check(msg_v0.force_atomic == false || it->has_flag(message_receiver::FORCE_ATOMIC), "unable to process message");
+            if (!message_receivers) message_receivers.emplace(get_self(), get_self().value);
+            auto it = message_receivers->find(receiver.value);
+            eosio::check(it != message_receivers->end(), "receiver not registered");
 
-        intx::uint256 min_fee((uint64_t)it->min_fee.amount);
-        min_fee *= intx::uint256(_config->get_minimum_natively_representable());
+            rit = receivers.emplace(receiver.value, receiver_state{
+                .handler = it->handler,
+                .flags   = it->flags,
+                .min_fee = intx::uint256((uint64_t)it->min_fee.amount) * minimum_natively_representable
+            }).first;
+        }
+        auto& rs = rit->second;
+
+        eosio::check(msg_v0.force_atomic == false || (rs.flags & message_receiver::FORCE_ATOMIC), "unable to process message");
 
         auto value = intx::be::unsafe::load<uint256>(rawmsg.value.bytes);
-        eosio::check(value >= min_fee, "min_fee not covered");
-
-        balances balance_table(get_self(), get_self().value);
-        const balance& receiver_account = balance_table.get(receiver.value, "receiver account is not open");
-
-        action(std::vector<permission_level>{}, it->handler, "onbridgemsg"_n,
-            bridge_message{ bridge_message_v0 {
-                .receiver  = msg_v0.get_account_as_name(),
-                .sender    = to_bytes(rawmsg.sender),
-                .timestamp = eosio::current_time_point(),
-                .value     = to_bytes(rawmsg.value),
-                .data      = msg_v0.data
-            } }
-        ).send();
+        eosio::check(value >= rs.min_fee, "min_fee not covered");
+
+        bridge_message message{ bridge_message_v0 {
+            .receiver  = receiver,
+            .sender    = to_bytes(rawmsg.sender),
+            .timestamp = eosio::current_time_point(),
+            .value     = to_bytes(rawmsg.value),
+            .data      = std::move(msg_v0.data)
+        } };
+
+        if (!msg_v0.force_atomic && (rs.flags & message_receiver::ASYNC_DELIVERY)) {
+            // The RAM of queued messages is paid by the contract (the receiver did not sign the EVM transaction),
+            // so the queue is bounded. Messages are only erased from the front, ids are consecutive.
+            eosio::check(std::get<bridge_message_v0>(message).data.size() <= max_queued_message_size,
+                         "bridge message too large to be queued");
+            auto& queue = queues.try_emplace(receiver.value, get_self(), receiver.value).first->second;
+            const auto next_id = queue.available_primary_key();
+            eosio::check(queue.begin() == queue.end() || next_id - queue.begin()->id < max_queued_messages,
+                         "message queue of receiver is full");
+            queue.emplace(get_self(), [&](auto& row) {
+                row.id      = next_id;
+                row.message = std::move(message);
+            });
+        } else if (rs.flags & message_receiver::BATCH_DELIVERY) {
+            if (!rs.batch) {
+                rs.batch = deliveries.size();
+                deliveries.push_back(delivery{ .handler = rs.handler, .batched = true });
+            }
+            deliveries[*rs.batch].messages.emplace_back(std::move(message));
+        } else {
+            deliveries.push_back(delivery{ .handler = rs.handler, .batched = false });
+            deliveries.back().messages.emplace_back(std::move(message));
+        }
 
+        rs.value += value;
+        accumulated_value += value;
+    }
+
+    if (receivers.empty()) {
+        return;
+    }
+
+    for(const auto& d : deliveries) {
+        deliver_bridge_messages(d.handler, d.batched, d.messages);
+    }
+
+    // A single balance update per receiver, regardless of the number of messages it got.
+    balances balance_table(get_self(), get_self().value);
+    for(const auto& [account, rs] : receivers) {
+        const balance& receiver_account = balance_table.get(account, "receiver account is not open");
+        if (rs.value == 0) {
+            continue;
+        }
         balance_table.modify(receiver_account, eosio::same_payer, [&](balance& row) {
-            row.balance += value;
+            row.balance += rs.value;
         });
-
-        accumulated_value += value;
     }
 
     if(accumulated_value > 0) {
-        balances balance_table(get_self(), get_self().value);
         const balance& self_balance = balance_table.get(get_self().value);
         balance_table.modify(self_balance, eosio::same_payer, [&](balance& row) {
             row.balance -= accumulated_value;
@@ -561,6 +695,16 @@ void evm_contract::process_filtered_messages(std::function<bool(const silkworm::
 
 }
 
+void evm_contract::deliver_bridge_messages(eosio::name handler, bool batched, const std::vector<bridge_message>& messages) {
+    if (batched) {
+        action(std::vector<permission_level>{}, handler, "onbridgemsgs"_n, messages).send();
+    } else {
+        for(const auto& message : messages) {
+            action(std::vector<permission_level>{}, handler, "onbridgemsg"_n, message).send();
+        }
+    }
+}
+
 void evm_contract::process_tx(const runtime_config& rc, eosio::name miner, const transaction& txn, std::optional<uint64_t> min_inclusion_price) {
     LOGTIME("EVM START1");
 
@@ -570,6 +714,9 @@ void evm_contract::process_tx(const runtime_config& rc, eosio::name miner, const
 
     auto current_version = _config->get_evm_version_and_maybe_promote();
 
+    check_block_gas_cap(rc);
+    const uint64_t block_gas_soft_cap = _config->get_block_gas().soft_cap;
+
     auto gas_param_pair = _config->get_consensus_param_and_maybe_promote();
     if (gas_param_pair.second) {
         // should not happen
@@ -594,6 +741,10 @@ void evm_contract::process_tx(const runtime_config& rc, eosio::name miner, const
     silkworm::protocol::TrustRuleSet engine{*found_chain_config->second};
 
     evm_runtime::state state{get_self(), get_self(), false, false};
+    const bool with_state_diff = current_version >= 3 && (_config->get_status() & static_cast<uint32_t>(status_flags::state_diff));
+    if (with_state_diff) {
+        state.enable_state_diff();
+    }
 
     auto gas_params = std::visit([&](const auto &v) {
         return evmone::gas_parameters(
@@ -614,6 +765,11 @@ void evm_contract::process_tx(const runtime_config& rc, eosio::name miner, const
     }
 
     auto gas_prices = _config->get_gas_prices();
+    if (current_version >= 3 && *base_fee_per_gas > gas_prices.get_base_price()) {
+        // Congestion raised the base fee over the admin prices, charge the difference as overhead so that it also
+        // reaches downstream nodes through the evmtx event.
+        gas_prices.overhead_price = *base_fee_per_gas;
+    }
     auto gp = silkworm::gas_prices_t{gas_prices.overhead_price.value_or(0), gas_prices.storage_price.value_or(0)};
     silkworm::ExecutionProcessor ep{block, engine, state, *found_chain_config->second, gp};
 
@@ -623,6 +779,9 @@ void evm_contract::process_tx(const runtime_config& rc, eosio::name miner, const
     });
 
     auto receipt = execute_tx(rc, miner, block, txn, ep, gas_params);
+    if (block_gas_soft_cap > 0) {
+        add_block_gas(receipt.cumulative_gas_used);
+    }
 
     // Filter EVM messages (with data) that are sent to the reserved address
     // corresponding to the EOS account holding the contract (self)
@@ -633,23 +792,30 @@ void evm_contract::process_tx(const runtime_config& rc, eosio::name miner, const
 
     engine.finalize(ep.state(), ep.evm().block());
     ep.state().write_to_db(ep.evm().block().header.number);
+#ifdef WITH_DB_STATS
+    // account read/update/create/remove then storage read/update/create/remove, parsed by tests/replay.hpp
+    eosio::print("db_stats: ", state.stats.account.read, " ", state.stats.account.update, " ", state.stats.account.create, " ",
+                 state.stats.account.remove, " ", state.stats.storage.read, " ", state.stats.storage.update, " ",
+                 state.stats.storage.create, " ", state.stats.storage.remove, "\n");
+#endif
+    collect_garbage();
 
     if (gas_param_pair.second) {
         configchange_action act{get_self(), std::vector<eosio::permission_level>()};
         act.send(gas_param_pair.first);
     }
 
-    if(current_version >= 3) {
-        auto event = evmtx_type{evmtx_v3{current_version, txn.get_rlptx(), gas_prices.overhead_price.value_or(0), gas_prices.storage_price.value_or(0)}};
-        action(std::vector<permission_level>{}, get_self(), "evmtx"_n, event).send();
+    if(with_state_diff) {
+        send_evmtx<evmtx_v4>(get_self(), current_version, txn.get_rlptx(), gas_prices.overhead_price.value_or(0), gas_prices.storage_price.value_or(0), *state._state_diff);
+    } else if(current_version >= 3) {
+        send_evmtx<evmtx_v3>(get_self(), current_version, txn.get_rlptx(), gas_prices.overhead_price.value_or(0), gas_prices.storage_price.value_or(0));
     } else if (current_version >= 1) {
-        auto event = evmtx_type{evmtx_v1{current_version, txn.get_rlptx(), *base_fee_per_gas}};
-        action(std::vector<permission_level>{}, get_self(), "evmtx"_n, event).send();
+        send_evmtx<evmtx_v1>(get_self(), current_version, txn.get_rlptx(), *base_fee_per_gas);
     }
     LOGTIME("EVM END");
 }
 
-void evm_contract::pushtx(eosio::name miner, bytes rlptx, eosio::binary_extension<uint64_t> min_inclusion_price) {
+void evm_contract::pushtx(eosio::name miner, eosio::ignore<bytes> rlptx, eosio::ignore<eosio::binary_extension<uint64_t>> min_inclusion_price) {
     LOGTIME("EVM START0");
     assert_unfrozen();
 
@@ -672,20 +838,31 @@ void evm_contract::pushtx(eosio::name miner, bytes rlptx, eosio::binary_extensio
     // not replay-protected (lacks a chain ID).
     // 4. Restrict miner to self: Ensures that if the transaction originates from
     // the contract then the miner must also be the contract itself.
+    // 5. Skip the block gas soft cap: the action that sent it has already
+    // checked it, unless it was a bridge transaction that is never rejected.
     if (get_sender() == get_self()) {
         rc.allow_special_signature = true;
         rc.abort_on_failure = true;
         rc.enforce_chain_id = false;
         rc.allow_non_self_miner = false;
+        rc.enforce_block_gas_cap = false;
     }
 
+    // rlptx is not copied out of the action data, it is decoded and forwarded to the evmtx event from there
+    auto& ds = get_datastream();
+    eosio::unsigned_int rlptx_size;
+    ds >> rlptx_size;
+    check(ds.remaining() >= rlptx_size.value, "unable to decode transaction");
+    ByteView rlptx_view{(const uint8_t*)ds.pos(), rlptx_size.value};
+    ds.skip(rlptx_size.value);
+
     std::optional<uint64_t> min_inclusion_price_;
-    if (min_inclusion_price.has_value()) {
-        min_inclusion_price_ = *min_inclusion_price;
+    if (ds.remaining() > 0) {
+        ds >> min_inclusion_price_.emplace();
         check(evm_version >= 1, "min_inclusion_price requires evm_version >= 1");
     }
 
-    process_tx(rc, miner, transaction{std::move(rlptx)}, min_inclusion_price_);
+    process_tx(rc, miner, transaction{rlptx_view}, min_inclusion_price_);
 }
 
 void evm_contract::open(eosio::name owner) {
@@ -696,17 +873,23 @@ void evm_contract::open(eosio::name owner) {
 
 void evm_contract::open_internal_balance(eosio::name owner) {
     balances balance_table(get_self(), get_self().value);
-    if(balance_table.find(owner.value) == balance_table.end())
-        balance_table.emplace(owner, [&](balance& a) {
-            a.owner = owner;
-            a.balance.balance = eosio::asset(0, _config->get_token_symbol());
-        });
+    if(balance_table.find(owner.value) != balance_table.end())
+        return;
 
+    // a re-opened account picks up the nonce it had when it was closed
+    uint64_t next_nonce = 0;
     nextnonces nextnonce_table(get_self(), get_self().value);
-    if(nextnonce_table.find(owner.value) == nextnonce_table.end())
-        nextnonce_table.emplace(owner, [&](nextnonce& a) {
-            a.owner = owner;
-        });
+    auto nonce_itr = nextnonce_table.find(owner.value);
+    if(nonce_itr != nextnonce_table.end()) {
+        next_nonce = nonce_itr->next_nonce;
+        nextnonce_table.erase(nonce_itr);
+    }
+
+    balance_table.emplace(owner, [&](balance& a) {
+        a.owner = owner;
+        a.balance.balance = eosio::asset(0, _config->get_token_symbol());
+        a.next_nonce = next_nonce;
+    });
 }
 
 void evm_contract::close(eosio::name owner) {
@@ -719,26 +902,71 @@ void evm_contract::close(eosio::name owner) {
     const balance& owner_account = balance_table.get(owner.value, "account is not open");
 
     eosio::check(owner_account.balance.is_zero(), "cannot close because balance is not zero");
-    balance_table.erase(owner_account);
 
-    nextnonces nextnonce_table(get_self(), get_self().value);
-    const nextnonce& next_nonce_for_owner = nextnonce_table.get(owner.value);
     //if the account has performed an EOS->EVM transfer the nonce needs to be maintained in case the account is re-opened in the future
-    if(next_nonce_for_owner.next_nonce == 0)
-        nextnonce_table.erase(next_nonce_for_owner);
+    nextnonces nextnonce_table(get_self(), get_self().value);
+    if(owner_account.next_nonce.has_value()) {
+        if(*owner_account.next_nonce > 0)
+            nextnonce_table.emplace(owner, [&](nextnonce& a) {
+                a.owner = owner;
+                a.next_nonce = *owner_account.next_nonce;
+            });
+    } else {
+        const nextnonce& next_nonce_for_owner = nextnonce_table.get(owner.value);
+        if(next_nonce_for_owner.next_nonce == 0)
+            nextnonce_table.erase(next_nonce_for_owner);
+    }
+
+    balance_table.erase(owner_account);
 }
 
 uint64_t evm_contract::get_and_increment_nonce(const name owner) {
+    balances balance_table(get_self(), get_self().value);
+    auto balance_itr = balance_table.find(owner.value);
+    if(balance_itr != balance_table.end() && balance_itr->next_nonce.has_value()) {
+        uint64_t ret = *balance_itr->next_nonce;
+        balance_table.modify(*balance_itr, eosio::same_payer, [](balance& b){
+            b.next_nonce = *b.next_nonce + 1;
+        });
+        return ret;
+    }
+
     nextnonces nextnonce_table(get_self(), get_self().value);
 
     const nextnonce& nonce = nextnonce_table.get(owner.value, "caller account has not been opened");
     uint64_t ret = nonce.next_nonce;
-    nextnonce_table.modify(nonce, eosio::same_payer, [](nextnonce& n){
-        ++n.next_nonce;
-    });
+    if(balance_itr != balance_table.end()) {
+        // migrate on first use
+        balance_table.modify(*balance_itr, eosio::same_payer, [&](balance& b){
+            b.next_nonce = ret + 1;
+        });
+        nextnonce_table.erase(nonce);
+    } else {
+        nextnonce_table.modify(nonce, eosio::same_payer, [](nextnonce& n){
+            ++n.next_nonce;
+        });
+    }
     return ret;
 }
 
+const evm_contract::egress_account_properties& evm_contract::get_egress_account_properties(eosio::name account) {
+    auto it = _egress_account_cache.find(account.value);
+    if (it != _egress_account_cache.end()) {
+        return it->second;
+    }
+
+    egress_account_properties props;
+    props.is_account = is_account(account);
+    if (props.is_account) {
+        props.has_code = get_code_hash(account) != checksum256();
+        if (props.has_code) {
+            egresslist egresslist_table(get_self(), get_self().value);
+            props.on_allow_list = egresslist_table.find(account.value) != egresslist_table.end();
+        }
+    }
+    return _egress_account_cache.emplace(account.value, props).first->second;
+}
+
 checksum256 evm_contract::get_code_hash(name account) const {
     char buff[64];
     eosio::check(internal_use_do_not_use::get_code_hash(account.value, 0, buff, sizeof(buff)) <= sizeof(buff), "get_code_hash() too big");
@@ -758,6 +986,8 @@ void evm_contract::handle_account_transfer(const eosio::asset& quantity, const s
     balance_table.modify(receiver_account, eosio::same_payer, [&](balance& a) {
         a.balance.balance += quantity;
     });
+
+    collect_garbage();
 }
 
 void evm_contract::handle_evm_transfer(eosio::asset quantity, const std::string& memo) {
@@ -774,13 +1004,15 @@ void evm_contract::handle_evm_transfer(eosio::asset quantity, const std::string&
     eosio::check(quantity.amount > 0, "must bridge more than ingress bridge fee");
 
     // Statistics
-    auto s = get_statistics();
-    s.ingress_bridge_fee_income.balance += _config->get_ingress_bridge_fee();
-    set_statistics(s);
+    add_ingress_fee_income(_config->get_ingress_bridge_fee());
 
     const std::optional<Bytes> address_bytes = from_hex(memo);
     eosio::check(!!address_bytes, "unable to parse destination address");
 
+    bridge_to_evm(to_evmc_address(*address_bytes), quantity, get_gas_price(current_version));
+}
+
+void evm_contract::bridge_to_evm(const evmc::address& destination, const eosio::asset& quantity, uint64_t txn_price) {
     intx::uint256 value((uint64_t)quantity.amount);
     value *= intx::uint256(_config->get_minimum_natively_representable());
 
@@ -798,14 +1030,12 @@ void evm_contract::handle_evm_transfer(eosio::asset quantity, const std::string&
         return gas_limit;
     };
 
-    auto txn_price = get_gas_price(current_version);
-
     Transaction txn;
     txn.type = TransactionType::kLegacy;
     txn.nonce = get_and_increment_nonce(get_self());
     txn.max_priority_fee_per_gas = txn_price;
     txn.max_fee_per_gas = txn_price;
-    txn.to = to_evmc_address(*address_bytes);
+    txn.to = destination;
     txn.gas_limit = calculate_gas_limit(*txn.to);
     txn.value = value;
     txn.r = 0u;  // r == 0 is pseudo signature that resolves to reserved address range
@@ -816,6 +1046,7 @@ void evm_contract::handle_evm_transfer(eosio::asset quantity, const std::string&
     rc.abort_on_failure = true;
     rc.enforce_chain_id = false;
     rc.allow_non_self_miner = false;
+    rc.enforce_block_gas_cap = false;
 
     dispatch_tx(rc, transaction{std::move(txn)});
 }
@@ -846,18 +1077,84 @@ void evm_contract::withdraw(eosio::name owner, eosio::asset quantity, const eosi
     assert_unfrozen();
     require_auth(owner);
 
+    withdraw_internal(owner, {{to.has_value() ? *to : owner, quantity}});
+
+    collect_garbage();
+}
+
+void evm_contract::withdrawmany(eosio::name owner, const std::vector<std::pair<eosio::name, eosio::asset>>& payouts) {
+    assert_unfrozen();
+    require_auth(owner);
+
+    eosio::check(!payouts.empty(), "no payouts");
+    withdraw_internal(owner, payouts);
+
+    collect_garbage();
+}
+
+void evm_contract::withdraw_internal(eosio::name owner, const std::vector<std::pair<eosio::name, eosio::asset>>& payouts) {
+    eosio::asset total(0, _config->get_token_symbol());
+    for(const auto& [to, quantity] : payouts) {
+        check(total.symbol == quantity.symbol, "invalid symbol");
+        check(quantity.amount > 0, "must withdraw positive quantity");
+        total += quantity;
+    }
+
     balances balance_table(get_self(), get_self().value);
     const balance& owner_account = balance_table.get(owner.value, "account is not open");
 
-    check(_config->get_token_symbol() == quantity.symbol, "invalid symbol");
-    check(owner_account.balance.balance.amount >= quantity.amount, "overdrawn balance");
+    check(owner_account.balance.balance.amount >= total.amount, "overdrawn balance");
     balance_table.modify(owner_account, eosio::same_payer, [&](balance& a) {
         a.balance.balance.symbol = _config->get_token_symbol();
-        a.balance.balance -= quantity;
+        a.balance.balance -= total;
     });
 
     token::transfer_action transfer_act(_config->get_token_contract(), {{get_self(), "active"_n}});
-    transfer_act.send(get_self(), to.has_value() ? *to : owner, quantity, std::string("Withdraw from EVM balance"));
+    for(const auto& [to, quantity] : payouts) {
+        transfer_act.send(get_self(), to, quantity, std::string("Withdraw from EVM balance"));
+    }
+}
+
+void evm_contract::bridgemany(eosio::name owner, const std::vector<std::pair<bytes, eosio::asset>>& credits) {
+    assert_unfrozen();
+    require_auth(owner);
+
+    eosio::check(!credits.empty(), "no credits");
+
+    auto current_version = _config->get_evm_version();
+    if(current_version >= 1) _config->process_price_queue();
+
+    const eosio::asset fee = _config->get_ingress_bridge_fee();
+    eosio::asset total(0, _config->get_token_symbol());
+    for(const auto& [to, quantity] : credits) {
+        check(total.symbol == quantity.symbol, "invalid symbol");
+        check(to.size() == kAddressLength, "unable to parse destination address");
+        check(quantity.amount > fee.amount, "must bridge more than ingress bridge fee");
+        total += quantity;
+    }
+
+    //move the whole amount from the owner's balance to the contract's balance in one step. each evm bridge trx will "pull" its credit from there
+    balances balance_table(get_self(), get_self().value);
+    const balance& owner_account = balance_table.get(owner.value, "account is not open");
+    check(owner_account.balance.balance.amount >= total.amount, "overdrawn balance");
+    balance_table.modify(owner_account, eosio::same_payer, [&](balance& a) {
+        a.balance.balance.symbol = _config->get_token_symbol();
+        a.balance.balance -= total;
+    });
+    balance_table.modify(balance_table.get(get_self().value), eosio::same_payer, [&](balance& b){
+        b.balance.balance += total;
+    });
+
+    // Statistics
+    add_ingress_fee_income(fee * static_cast<int64_t>(credits.size()));
+
+    // one evm trx per credit so that nodes see the same kind of transactions as for single deposits
+    auto txn_price = get_gas_price(current_version);
+    for(const auto& [to, quantity] : credits) {
+        bridge_to_evm(to_evmc_address(ByteView{(const uint8_t*)to.data(), to.size()}), quantity - fee, txn_price);
+    }
+
+    collect_garbage();
 }
 
 bool evm_contract::gc(uint32_t max) {
@@ -868,6 +1165,69 @@ bool evm_contract::gc(uint32_t max) {
     return state.gc(max);
 }
 
+bytes evm_contract::getdigest(const std::optional<bytes>& address) {
+    state_digest_singleton digest(get_self(), get_self().value);
+    eosio::check(digest.exists(), "state digest is not tracked");
+    eosio::check(!digest.get().seed.has_value(), "state digest is still being seeded");
+
+    if (!address) {
+        return digest.get().digest;
+    }
+
+    eosio::check(address->size() == kAddressLength, err_msg_invalid_addr);
+    account_table accounts(get_self(), get_self().value);
+    auto inx = accounts.get_index<"by.address"_n>();
+    auto itr = inx.find(make_key(*address));
+    if (itr == inx.end()) {
+        return bytes(32, 0);
+    }
+
+    evm_runtime::state state{get_self(), get_self(), true};
+    return to_bytes(state.account_digest(*itr));
+}
+
+storage_top_page evm_contract::topstorage(uint64_t cursor, uint32_t scan, uint32_t max) {
+    eosio::check(scan > 0, "scan must be greater than zero");
+
+    // Min-heap on storage_slots holding the current top entries
+    auto larger = [](const account_storage& a, const account_storage& b) { return a.storage_slots > b.storage_slots; };
+    storage_top_page page;
+    auto& top = page.accounts;
+
+    account_table accounts(get_self(), get_self().value);
+    auto itr = accounts.lower_bound(cursor);
+    for(uint32_t scanned = 0; itr != accounts.end() && scanned < scan; ++itr, ++scanned) {
+        const auto& a = *itr;
+        if (max == 0 || !a.storage_slots.has_value() || *a.storage_slots == 0) {
+            continue;
+        }
+        if (top.size() == max) {
+            if (*a.storage_slots <= top.front().storage_slots) {
+                continue;
+            }
+            std::pop_heap(top.begin(), top.end(), larger);
+            top.pop_back();
+        }
+        top.push_back(account_storage{a.id, a.eth_address, *a.storage_slots});
+        std::push_heap(top.begin(), top.end(), larger);
+    }
+    if (itr != accounts.end()) {
+        page.next = itr->id;
+    }
+
+    std::sort_heap(top.begin(), top.end(), larger);
+    return page;
+}
+
+void evm_contract::collect_garbage() {
+    const uint32_t budget = _config->get_gc_budget();
+    if (budget == 0) {
+        return;
+    }
+    evm_runtime::state state{get_self(), eosio::same_payer};
+    state.gc(budget);
+}
+
 void evm_contract::call_(const runtime_config& rc, intx::uint256 s, const bytes& to, intx::uint256 value, const bytes& data, uint64_t gas_limit, uint64_t nonce) {
     auto current_version = _config->get_evm_version();
     if(current_version >= 1) _config->process_price_queue();
@@ -899,8 +1259,10 @@ void evm_contract::dispatch_tx(const runtime_config& rc, const transaction& tx)
         process_tx(rc, get_self(), tx, {} /* min_inclusion_price */);
     } else {
         eosio::check(!rc.gas_payer && rc.allow_special_signature && rc.abort_on_failure && !rc.enforce_chain_id && !rc.allow_non_self_miner, "invalid runtime config");
+        // the inline pushtx does not enforce the soft cap
+        check_block_gas_cap(rc);
         action(permission_level{get_self(),"active"_n}, get_self(), "pushtx"_n,
-            std::tuple<eosio::name, bytes>(get_self(), tx.get_rlptx())
+            std::tuple<eosio::name, bytes>(get_self(), bytes{tx.get_rlptx().begin(), tx.get_rlptx().end()})
         ).send();
     }
 }
@@ -985,7 +1347,7 @@ void evm_contract::admincall(const bytes& from, const bytes& to, const bytes& va
     call_(rc, s, to, v, data, gas_limit, nonce);
 }
 
-void evm_contract::bridgereg(eosio::name receiver, eosio::name handler, const eosio::asset& min_fee) {
+void evm_contract::bridgereg(eosio::name receiver, eosio::name handler, const eosio::asset& min_fee, const eosio::binary_extension<uint32_t>& flags) {
     assert_unfrozen();
     require_auth(receiver);
     require_auth(get_self());  // to temporarily prevent registration of unauthorized accounts
@@ -993,11 +1355,14 @@ void evm_contract::bridgereg(eosio::name receiver, eosio::name handler, const eo
     eosio::check(min_fee.symbol == _config->get_token_symbol(), "unexpected symbol");
     eosio::check(min_fee.amount >= 0, "min_fee cannot be negative");
 
+    const uint32_t extra_flags = flags.value_or(0);
+    eosio::check((extra_flags & ~message_receiver::OPTIONAL_FLAGS) == 0, "invalid flags");
+
     auto update_row = [&](auto& row) {
         row.account = receiver;
         row.handler = handler;
         row.min_fee = min_fee;
-        row.flags   = message_receiver::FORCE_ATOMIC;
+        row.flags   = message_receiver::FORCE_ATOMIC | extra_flags;
     };
 
     message_receiver_table message_receivers(get_self(), get_self().value);
@@ -1019,11 +1384,42 @@ void evm_contract::bridgeunreg(eosio::name receiver) {
     message_receiver_table message_receivers(get_self(), get_self().value);
     auto it = message_receivers.find(receiver.value);
     eosio::check(it != message_receivers.end(), "receiver not found");
+
+    message_queue_table queue(get_self(), receiver.value);
+    eosio::check(queue.begin() == queue.end(), "message queue is not empty");
+
     message_receivers.erase(*it);
 }
 
+bool evm_contract::pullmsgs(eosio::name receiver, uint32_t max) {
+    assert_unfrozen();
+    eosio::check(max > 0, "max must be greater than zero");
+
+    message_receiver_table message_receivers(get_self(), get_self().value);
+    const auto& r = message_receivers.get(receiver.value, "receiver not registered");
+
+    message_queue_table queue(get_self(), receiver.value);
+    std::vector<bridge_message> messages;
+    for(auto it = queue.begin(); it != queue.end() && messages.size() < max; ) {
+        messages.emplace_back(it->message);
+        it = queue.erase(it);
+    }
+    eosio::check(!messages.empty(), "no queued messages");
+
+    deliver_bridge_messages(r.handler, r.flags & message_receiver::BATCH_DELIVERY, messages);
+
+    return queue.begin() == queue.end();
+}
+
 
 void evm_contract::assertnonce(eosio::name account, uint64_t next_nonce) { 
+    balances balance_table(get_self(), get_self().value);
+    auto balance_itr = balance_table.find(account.value);
+    if (balance_itr != balance_table.end() && balance_itr->next_nonce.has_value()) {
+        eosio::check(*balance_itr->next_nonce == next_nonce, "wrong nonce");
+        return;
+    }
+
     nextnonces nextnonce_table(get_self(), get_self().value);
 
     auto next_nonce_iter = nextnonce_table.find(account.value);
@@ -1074,7 +1470,189 @@ void evm_contract::setgaslimit(uint64_t ingress_gas_limit) {
     _config->set_ingress_gas_limit(ingress_gas_limit);
 }
 
+void evm_contract::setstatediff(bool enabled) {
+    eosio::require_auth(get_self());
+
+    assert_inited();
+    auto status = _config->get_status();
+    if (enabled) {
+        check(_config->get_evm_version() >= 3, "state diff requires evm_version >= 3");
+        status |= static_cast<uint32_t>(status_flags::state_diff);
+    } else {
+        status &= ~static_cast<uint32_t>(status_flags::state_diff);
+    }
+    _config->set_status(status);
+}
+
+void evm_contract::setgcbudget(uint32_t budget) {
+    require_auth(get_self());
+    _config->set_gc_budget(budget);
+}
+
+void evm_contract::setblockgas(uint64_t soft_cap, uint32_t max_base_fee_multiplier) {
+    require_auth(get_self());
+    assert_inited();
+
+    if (max_base_fee_multiplier > 1) {
+        check(soft_cap > 0, "dynamic base fee requires a soft cap");
+        check(_config->get_evm_version() >= 1, "dynamic base fee requires evm_version >= 1");
+    }
+    _config->set_block_gas(block_gas_params{.soft_cap = soft_cap, .max_base_fee_multiplier = max_base_fee_multiplier});
+
+    if (soft_cap == 0) {
+        // Tracking stops, do not let old rows drive the base fee if it is turned back on later
+        fold_fee_income(std::numeric_limits<uint64_t>::max(), _config->get_token_symbol());
+        block_gas_table blocks(get_self(), get_self().value);
+        for (auto itr = blocks.begin(); itr != blocks.end();) {
+            itr = blocks.erase(itr);
+        }
+    }
+}
+
+std::vector<block_gas> evm_contract::getblockgas() {
+    block_gas_table blocks(get_self(), get_self().value);
+    return {blocks.begin(), blocks.end()};
+}
+
+const block_gas& evm_contract::get_block_gas() {
+    if (!_block_gas) {
+        eosevm::block_mapping bm(_config->get_genesis_time().sec_since_epoch());
+        const uint64_t block_num = bm.timestamp_to_evm_block_num(eosio::current_time_point().time_since_epoch().count());
+
+        block_gas_table blocks(get_self(), get_self().value);
+        auto itr = blocks.lower_bound(block_num);
+        if (itr != blocks.end() && itr->block_num == block_num) {
+            _block_gas = std::make_shared<block_gas>(*itr);
+        } else {
+            const eosio::asset zero(0, _config->get_token_symbol());
+            _block_gas = std::make_shared<block_gas>(block_gas{
+                .block_num = block_num,
+                .gas_fee_income = { .balance = zero, .dust = 0 },
+                .ingress_bridge_fee_income = { .balance = zero, .dust = 0 },
+            });
+            if (_config->get_block_gas().dynamic_base_fee()) {
+                const uint64_t floor = get_admin_gas_price(_config->get_evm_version());
+                _block_gas->base_fee = itr != blocks.begin() ? next_base_fee(*std::prev(itr), block_num, floor) : floor;
+            }
+        }
+    }
+    return *_block_gas;
+}
+
+// Bridge transactions are counted but never rejected: the tokens already moved.
+void evm_contract::check_block_gas_cap(const runtime_config& rc) {
+    const uint64_t soft_cap = _config->get_block_gas().soft_cap;
+    if (soft_cap > 0 && rc.enforce_block_gas_cap) {
+        eosio::check(get_block_gas().gas_used < soft_cap, "block gas soft cap reached");
+    }
+}
+
+void evm_contract::add_block_gas(uint64_t gas_used) {
+    get_block_gas();
+    _block_gas->gas_used += gas_used;
+    _block_gas_dirty = true;
+}
+
+void evm_contract::flush_block_gas() {
+    if (!_block_gas_dirty) {
+        return;
+    }
+    _block_gas_dirty = false;
+
+    block_gas_table blocks(get_self(), get_self().value);
+    auto itr = blocks.find(_block_gas->block_num);
+    if (itr != blocks.end()) {
+        blocks.modify(itr, eosio::same_payer, [&](auto& row) {
+            row = *_block_gas;
+        });
+        return;
+    }
+
+    // First write of a new EVM block: the income of the previous ones is final
+    fold_fee_income(_block_gas->block_num, _config->get_token_symbol());
+    blocks.emplace(get_self(), [&](auto& row) {
+        row = *_block_gas;
+    });
+    for (auto it = blocks.begin(); it != blocks.end() && it->block_num + block_gas_window <= _block_gas->block_num;) {
+        it = blocks.erase(it);
+    }
+}
+
+// Moves the fee income of the rows before before_block_num into the statistics and resets it to 0 of symbol.
+void evm_contract::fold_fee_income(uint64_t before_block_num, eosio::symbol symbol) {
+    block_gas_table blocks(get_self(), get_self().value);
+    for (auto itr = blocks.begin(); itr != blocks.end() && itr->block_num < before_block_num; ++itr) {
+        if (itr->gas_fee_income.is_zero() && itr->ingress_bridge_fee_income.is_zero()) {
+            continue;
+        }
+        auto s = get_statistics();
+        s.gas_fee_income.balance += itr->gas_fee_income.balance;
+        s.gas_fee_income += intx::uint256(itr->gas_fee_income.dust);
+        s.ingress_bridge_fee_income.balance += itr->ingress_bridge_fee_income.balance;
+        s.ingress_bridge_fee_income += intx::uint256(itr->ingress_bridge_fee_income.dust);
+        set_statistics(s);
+
+        blocks.modify(itr, eosio::same_payer, [&](auto& row) {
+            row.gas_fee_income = { .balance = eosio::asset(0, symbol), .dust = 0 };
+            row.ingress_bridge_fee_income = { .balance = eosio::asset(0, symbol), .dust = 0 };
+        });
+    }
+}
+
+void evm_contract::add_gas_fee_income(const intx::uint256& fee) {
+    if (_config->get_block_gas().soft_cap > 0) {
+        get_block_gas();
+        _block_gas->gas_fee_income += fee;
+        _block_gas_dirty = true;
+        return;
+    }
+    auto s = get_statistics();
+    s.gas_fee_income += fee;
+    set_statistics(s);
+}
+
+void evm_contract::add_ingress_fee_income(const eosio::asset& fee) {
+    if (_config->get_block_gas().soft_cap > 0) {
+        get_block_gas();
+        _block_gas->ingress_bridge_fee_income.balance += fee;
+        _block_gas_dirty = true;
+        return;
+    }
+    auto s = get_statistics();
+    s.ingress_bridge_fee_income.balance += fee;
+    set_statistics(s);
+}
+
+// EIP-1559: the base fee moves by up to 1/8 per block, up when the previous block used more than half of the soft cap
+// and down when it used less. EVM blocks without any transaction are empty blocks, each of them lowers it by 1/8.
+uint64_t evm_contract::next_base_fee(const block_gas& prev, uint64_t block_num, uint64_t floor) const {
+    const auto& params = _config->get_block_gas();
+    const intx::uint256 target = std::max<uint64_t>(params.soft_cap / 2, 1);
+    const intx::uint256 gas_used = prev.gas_used;
+    const intx::uint256 ceiling = std::min<intx::uint256>(intx::uint256{floor} * params.max_base_fee_multiplier,
+                                                          std::numeric_limits<uint64_t>::max());
+
+    intx::uint256 fee = std::clamp<intx::uint256>(prev.base_fee, floor, ceiling);
+    if (gas_used > target) {
+        fee += std::max<intx::uint256>(fee * (gas_used - target) / target / 8, 1);
+    } else {
+        fee -= fee * (target - gas_used) / target / 8;
+    }
+    for (uint64_t empty = block_num - prev.block_num - 1; empty > 0 && fee > floor; --empty) {
+        fee -= std::max<intx::uint256>(fee / 8, 1);
+    }
+    return static_cast<uint64_t>(std::clamp<intx::uint256>(fee, floor, ceiling));
+}
+
 uint64_t evm_contract::get_gas_price(uint64_t evm_version) {
+    const uint64_t price = get_admin_gas_price(evm_version);
+    if (evm_version >= 1 && _config->get_block_gas().dynamic_base_fee()) {
+        return std::max(price, get_block_gas().base_fee);
+    }
+    return price;
+}
+
+uint64_t evm_contract::get_admin_gas_price(uint64_t evm_version) {
     if( evm_version >= 3) {
         auto gas_prices = _config->get_gas_prices();
         return gas_prices.get_base_price();
@@ -1082,18 +1660,39 @@ uint64_t evm_contract::get_gas_price(uint64_t evm_version) {
     return _config->get_gas_price();
 }
 
-statistics evm_contract::get_statistics() const { 
-    statistics_singleton statistics_v(get_self(), get_self().value);
-    return statistics_v.get_or_create(get_self(), statistics {
-        .version = 0,
-        .ingress_bridge_fee_income = { .balance = eosio::asset(0, _config->get_ingress_bridge_fee().symbol), .dust = 0 },
-        .gas_fee_income = { .balance = eosio::asset(0, _config->get_ingress_bridge_fee().symbol), .dust = 0 },
-    });
+statistics evm_contract::get_statistics() {
+    if (!_statistics) {
+        statistics_singleton statistics_v(get_self(), get_self().value);
+        if (statistics_v.exists()) {
+            _statistics = std::make_shared<statistics>(statistics_v.get());
+        } else {
+            _statistics = std::make_shared<statistics>(statistics {
+                .version = 0,
+                .ingress_bridge_fee_income = { .balance = eosio::asset(0, _config->get_ingress_bridge_fee().symbol), .dust = 0 },
+                .gas_fee_income = { .balance = eosio::asset(0, _config->get_ingress_bridge_fee().symbol), .dust = 0 },
+            });
+            // Don't set dirty, the row is only created once there is something to record.
+        }
+    }
+    return *_statistics;
 }
 
 void evm_contract::set_statistics(const statistics &v) {
+    if (!_statistics) {
+        _statistics = std::make_shared<statistics>(v);
+    } else {
+        *_statistics = v;
+    }
+    _statistics_dirty = true;
+}
+
+void evm_contract::flush_statistics() {
+    if (!_statistics_dirty) {
+        return;
+    }
     statistics_singleton statistics_v(get_self(), get_self().value);
-    statistics_v.set(v, get_self());
+    statistics_v.set(*_statistics, get_self());
+    _statistics_dirty = false;
 }
 
 void evm_contract::swapgastoken(eosio::name new_token_contract, eosio::symbol new_symbol, eosio::name swap_dest_account, string swap_memo) {
@@ -1102,6 +1701,8 @@ void evm_contract::swapgastoken(eosio::name new_token_contract, eosio::symbol ne
     // config table
     eosio::name old_token_contract = _config->get_token_contract();
     eosio::symbol old_symbol = _config->get_token_symbol();
+    // The income not yet in the statistics is in the old token
+    fold_fee_income(std::numeric_limits<uint64_t>::max(), new_symbol);
     _config->swapgastoken(new_token_contract, new_symbol);
 
     // inevm table
@@ -1153,4 +1754,76 @@ void evm_contract::migratebal(eosio::name from_name, int limit) {
     eosio::check(count > 0, "nothing changed");
 }
 
+void evm_contract::migratenonce(eosio::name from_name, int limit) {
+    int count = 0;
+    balances balance_table(get_self(), get_self().value);
+    nextnonces nextnonce_table(get_self(), get_self().value);
+    for (auto it = nextnonce_table.lower_bound(from_name.value); limit > 0 && it != nextnonce_table.end(); --limit) {
+        auto balance_itr = balance_table.find(it->owner.value);
+        // rows without a balance belong to closed accounts and stay where they are
+        if (balance_itr == balance_table.end() || balance_itr->next_nonce.has_value()) {
+            ++it;
+            continue;
+        }
+        balance_table.modify(*balance_itr, eosio::same_payer, [&](balance &row){
+            row.next_nonce = it->next_nonce;
+        });
+        it = nextnonce_table.erase(it);
+        ++count;
+    }
+    eosio::check(count > 0, "nothing changed");
+}
+
+bool evm_contract::seeddigest(uint32_t max) {
+    require_auth(get_self());
+    eosio::check(max > 0, "max must be greater than zero");
+
+    state_digest_singleton digest(get_self(), get_self().value);
+    auto value = digest.get_or_default(state_digest{.digest = bytes(32, 0)});
+    if (!digest.exists()) {
+        value.seed = digest_seed{};
+    }
+    eosio::check(value.seed.has_value(), "state digest is already seeded");
+    auto& seed = value.seed.value();
+
+    evm_runtime::state state{get_self(), get_self(), true};
+    account_table accounts(get_self(), get_self().value);
+    uint32_t rows = 0;
+    auto itr = accounts.lower_bound(seed.account_id);
+    while (itr != accounts.end() && rows < max) {
+        // the account seed points at may be gone, start over with the next one
+        if (itr->id != seed.account_id) {
+            seed = digest_seed{.account_id = itr->id};
+        }
+
+        storage_table db(get_self(), itr->id);
+        uint256 storage_digest = to_uint256(seed.storage_digest);
+        auto sitr = db.lower_bound(seed.slot_id);
+        for (; sitr != db.end() && rows < max; ++sitr, ++rows) {
+            storage_digest += state.slot_leaf(itr->eth_address, sitr->key, sitr->value);
+            ++seed.storage_slots;
+            seed.slot_id = sitr->id + 1;
+        }
+        seed.storage_digest = to_bytes(storage_digest);
+        if (sitr != db.end()) break;
+
+        // the row grows, the contract pays for it like for every account row
+        accounts.modify(*itr, get_self(), [&](auto& row) {
+            if (!row.storage_slots.has_value()) row.storage_slots = seed.storage_slots;
+            row.storage_digest = seed.storage_digest;
+        });
+        value.digest = to_bytes(to_uint256(value.digest) + state.account_leaf(*itr) + storage_digest);
+        seed = digest_seed{.account_id = itr->id + 1};
+        ++itr;
+        ++rows;
+    }
+
+    const bool seeded = itr == accounts.end();
+    if (seeded) {
+        value.seed.reset();
+    }
+    digest.set(value, get_self());
+    return seeded;
+}
+
 } //evm_runtime
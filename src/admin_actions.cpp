@@ -1,6 +1,11 @@
+#include <set>
+
 #include <eosio/system.hpp>
 #include <evm_runtime/evm_contract.hpp>
 #include <evm_runtime/tables.hpp>
+#include <evm_runtime/state.hpp>
+
+#include <ethash/keccak.hpp>
 
 namespace evm_runtime {
 [[eosio::action]] void evm_contract::rmgcstore(uint64_t id) {
@@ -19,21 +24,43 @@ namespace evm_runtime {
     auto inx = db.get_index<"by.key"_n>();
     auto itr = inx.find(make_key(key));
 
+    account_table accounts(get_self(), get_self().value);
+    auto aitr = accounts.find(account_id);
+
+    auto add_storage_slots = [&](int64_t delta) {
+        if(aitr == accounts.end() || !aitr->storage_slots.has_value()) return;
+        accounts.modify(*aitr, eosio::same_payer, [&](auto& row){
+            row.storage_slots = *row.storage_slots + delta;
+        });
+    };
+
+    evm_runtime::state state{get_self(), eosio::same_payer};
+    auto digest_slot = [&](const storage& slot, bool add) {
+        if(aitr == accounts.end()) return;
+        state.digest_slot(account_id, aitr->eth_address, slot, add);
+    };
+
     if(value.has_value()) {
         if(itr == inx.end()) {
-            db.emplace(get_self(), [&](auto& row){
+            auto sitr = db.emplace(get_self(), [&](auto& row){
                 row.id = db.available_primary_key();
                 row.key = key;
                 row.value = value.value();
             });
+            add_storage_slots(1);
+            digest_slot(*sitr, true);
         } else {
+            digest_slot(*itr, false);
             db.modify(*itr, eosio::same_payer, [&](auto& row){
                 row.value = value.value();
             });
+            digest_slot(*itr, true);
         }
     } else {
         eosio::check(itr != inx.end(), "key not found");
+        digest_slot(*itr, false);
         db.erase(*itr);
+        add_storage_slots(-1);
     }
 }
 
@@ -43,6 +70,9 @@ namespace evm_runtime {
     auto itr = accounts.find(id);
     eosio::check(itr != accounts.end(), "account not found");
 
+    evm_runtime::state state{get_self(), eosio::same_payer};
+    state.digest_remove_account(*itr);
+
     if (itr->code_id) {
         account_code_table codes(get_self(), get_self().value);
         const auto& itrc = codes.get(itr->code_id.value(), "code not found");
@@ -59,6 +89,7 @@ namespace evm_runtime {
     gc.emplace(get_self(), [&](auto& row){
         row.id = gc.available_primary_key();
         row.storage_id = itr->id;
+        if (itr->storage_slots.has_value()) row.storage_slots = *itr->storage_slots;
     });
 
     accounts.erase(*itr);
@@ -84,9 +115,12 @@ namespace evm_runtime {
         inevm.set(inevm.get()+=d, eosio::same_payer);
     }
 
+    evm_runtime::state state{get_self(), eosio::same_payer};
+    state.digest_account(*itr, false);
     accounts.modify(*itr, eosio::same_payer, [&](auto& row){
         row.balance = to_bytes(res.value);
     });
+    state.digest_account(*itr, true);
 }
 
 [[eosio::action]] void evm_contract::addopenbal(name account, const bytes& delta, bool subtract) {
@@ -121,4 +155,142 @@ namespace evm_runtime {
     });
 }
 
+[[eosio::action]] void evm_contract::resetdigest() {
+    eosio::require_auth(get_self());
+    state_digest state_digest_value{.digest = bytes(32, 0)};
+    state_digest_value.seed = digest_seed{};
+    state_digest_singleton(get_self(), get_self().value).set(state_digest_value, get_self());
+}
+
+
+[[eosio::action]] void evm_contract::importstate(const eosio::checksum256& checksum, eosio::ignore<state_batch> batch) {
+    eosio::require_auth(get_self());
+    assert_inited();
+
+    auto& ds = get_datastream();
+    eosio::check(eosio::sha256(ds.pos(), ds.remaining()) == checksum, "checksum mismatch");
+    state_batch b;
+    ds >> b;
+
+    size_t rows = b.accounts.size() + b.codes.size();
+    for(const auto& a : b.accounts) rows += a.storage.size();
+    eosio::check(rows <= max_import_rows, "batch too large");
+
+    // Only the codes of accounts of this batch are accepted, nothing is stored or dropped silently
+    std::set<eosio::checksum256> referenced_codes;
+    for(const auto& a : b.accounts) {
+        if(a.code_hash) referenced_codes.insert(make_key(*a.code_hash));
+    }
+    std::map<eosio::checksum256, const bytes*> batch_codes;
+    for(const auto& code : b.codes) {
+        auto hash = ethash::keccak256(reinterpret_cast<const uint8_t*>(code.data()), code.size());
+        const auto key = make_key(to_bytes(intx::be::load<uint256>(hash)));
+        eosio::check(referenced_codes.count(key) > 0, "code not referenced by the batch");
+        batch_codes[key] = &code;
+    }
+
+    evm_runtime::state state{get_self(), get_self()};
+    account_table accounts(get_self(), get_self().value);
+    account_code_table codes(get_self(), get_self().value);
+    auto by_address = accounts.get_index<"by.address"_n>();
+    auto by_codehash = codes.get_index<"by.codehash"_n>();
+    inevm_singleton inevm(get_self(), get_self().value);
+    auto inevm_balance = inevm.get();
+
+    auto get_code_id = [&](const bytes& code_hash) -> uint64_t {
+        eosio::check(code_hash.size() == 32, "invalid code hash");
+        const auto key = make_key(code_hash);
+        auto itr = by_codehash.find(key);
+        if(itr != by_codehash.end()) {
+            by_codehash.modify(itr, eosio::same_payer, [&](auto& row){
+                row.ref_count++;
+            });
+            return itr->id;
+        }
+
+        auto citr = batch_codes.find(key);
+        eosio::check(citr != batch_codes.end(), "code not found");
+        const uint64_t code_id = codes.available_primary_key();
+        codes.emplace(get_self(), [&](auto& row){
+            row.id = code_id;
+            row.code_hash = code_hash;
+            row.code = *citr->second;
+            row.ref_count = 1;
+        });
+        return code_id;
+    };
+
+    for(const auto& a : b.accounts) {
+        eosio::check(a.address.size() == 20, "invalid address");
+        eosio::check(a.balance.size() == 32, "invalid balance");
+
+        auto itr = by_address.find(make_key(a.address));
+        uint64_t account_id;
+        if(itr == by_address.end()) {
+            auto aitr = accounts.emplace(get_self(), [&](auto& row){
+                row.id = state.get_next_account_id();
+                row.eth_address = a.address;
+                row.nonce = a.nonce;
+                row.balance = a.balance;
+                if(a.code_hash) row.code_id = get_code_id(*a.code_hash);
+                row.flags = 0;
+                row.storage_slots = 0;
+                if(state.digest_enabled()) row.storage_digest = bytes(32, 0);
+            });
+            state.digest_account(*aitr, true);
+            inevm_balance += to_uint256(a.balance);
+            account_id = aitr->id;
+        } else {
+            state.digest_account(*itr, false);
+            inevm_balance += to_uint256(a.balance);
+            inevm_balance -= to_uint256(itr->balance);
+            by_address.modify(itr, eosio::same_payer, [&](auto& row){
+                row.nonce = a.nonce;
+                row.balance = a.balance;
+                if(a.code_hash) {
+                    if(row.code_id) {
+                        eosio::check(codes.get(*row.code_id, "code not found").code_hash == *a.code_hash, "code mismatch");
+                    } else {
+                        row.code_id = get_code_id(*a.code_hash);
+                    }
+                }
+            });
+            state.digest_account(*itr, true);
+            account_id = itr->id;
+        }
+
+        storage_table db(get_self(), account_id);
+        auto by_key = db.get_index<"by.key"_n>();
+        for(const auto& slot : a.storage) {
+            eosio::check(slot.key.size() == 32 && slot.value.size() == 32, "invalid key/value size");
+            const bool clear = std::all_of(slot.value.begin(), slot.value.end(), [](char c) { return c == 0; });
+
+            auto sitr = by_key.find(make_key(slot.key));
+            if(sitr != by_key.end()) {
+                state.digest_slot(account_id, a.address, *sitr, false);
+                if(clear) {
+                    by_key.erase(sitr);
+                    state.adjust_storage_slots(account_id, -1);
+                    continue;
+                }
+                by_key.modify(sitr, eosio::same_payer, [&](auto& row){
+                    row.value = slot.value;
+                });
+                state.digest_slot(account_id, a.address, *sitr, true);
+            } else {
+                if(clear) continue;
+                auto nitr = db.emplace(get_self(), [&](auto& row){
+                    row.id = db.available_primary_key();
+                    row.key = slot.key;
+                    row.value = slot.value;
+                });
+                state.adjust_storage_slots(account_id, 1);
+                state.digest_slot(account_id, a.address, *nitr, true);
+            }
+        }
+    }
+
+    inevm.set(inevm_balance, eosio::same_payer);
+}
+
 }
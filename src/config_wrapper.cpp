@@ -30,6 +30,12 @@ config_wrapper::config_wrapper(eosio::name self) : _self(self), _config(self, se
     if (!_cached_config.ingress_gas_limit.has_value()) {
         _cached_config.ingress_gas_limit = 21000;
     }
+    if (!_cached_config.gc_budget.has_value()) {
+        _cached_config.gc_budget = 0;
+    }
+    if (!_cached_config.block_gas.has_value()) {
+        _cached_config.block_gas = block_gas_params{};
+    }
 }
 
 config_wrapper::~config_wrapper() {
@@ -418,6 +424,24 @@ uint64_t config_wrapper::get_ingress_gas_limit() const {
     return *_cached_config.ingress_gas_limit;
 }
 
+void config_wrapper::set_gc_budget(uint32_t budget) {
+    _cached_config.gc_budget = budget;
+    set_dirty();
+}
+
+uint32_t config_wrapper::get_gc_budget() const {
+    return *_cached_config.gc_budget;
+}
+
+void config_wrapper::set_block_gas(const block_gas_params& params) {
+    _cached_config.block_gas = params;
+    set_dirty();
+}
+
+const block_gas_params& config_wrapper::get_block_gas() const {
+    return *_cached_config.block_gas;
+}
+
 void config_wrapper::swapgastoken(name new_token_contract, symbol new_symbol) {
     _cached_config.ingress_bridge_fee.symbol = new_symbol;
     _cached_config.token_contract = new_token_contract;
@@ -0,0 +1,107 @@
+#include <map>
+
+#include <evm_runtime/evm_contract.hpp>
+#include <evm_runtime/tables.hpp>
+
+namespace evm_runtime {
+
+namespace {
+// Worst case framing of a page: the size of its row vector (varint, up to 5 bytes), the next cursor
+// (optional<uint64_t>, 9 bytes) and, for code pages, next_offset (4 bytes)
+constexpr uint32_t vector_size_overhead  = 5;
+constexpr uint32_t cursor_overhead       = 9;
+constexpr uint32_t account_page_overhead = vector_size_overhead + cursor_overhead;
+constexpr uint32_t code_page_overhead    = vector_size_overhead + cursor_overhead + sizeof(uint32_t);
+constexpr uint32_t storage_page_overhead = vector_size_overhead + cursor_overhead;
+
+uint32_t page_budget(uint32_t max_bytes, uint32_t page_overhead) {
+    eosio::check(max_bytes > page_overhead, "max_bytes too small");
+    return max_bytes - page_overhead;
+}
+} // namespace
+
+[[eosio::action, eosio::read_only]] account_page evm_contract::exportaccts(uint64_t cursor, uint32_t max_bytes) {
+    uint32_t budget = page_budget(max_bytes, account_page_overhead);
+    account_page page;
+
+    account_table accounts(get_self(), get_self().value);
+    account_code_table codes(get_self(), get_self().value);
+    // Accounts of the same contract share a code row, deserialize it (bytecode included) once per page
+    std::map<uint64_t, bytes> id2codehash;
+    for (auto itr = accounts.lower_bound(cursor); itr != accounts.end(); ++itr) {
+        exported_account row{itr->id, itr->eth_address, itr->nonce, itr->balance, {}};
+        if (itr->code_id) {
+            auto hitr = id2codehash.find(itr->code_id.value());
+            if (hitr == id2codehash.end()) {
+                auto citr = codes.find(itr->code_id.value());
+                hitr = id2codehash.emplace(itr->code_id.value(), citr != codes.end() ? citr->code_hash : bytes{}).first;
+            }
+            row.code_hash = hitr->second;
+        }
+
+        const size_t size = eosio::pack_size(row);
+        if (size > budget) {
+            eosio::check(!page.accounts.empty(), "max_bytes too small");
+            page.next = itr->id;
+            break;
+        }
+        budget -= size;
+        page.accounts.emplace_back(std::move(row));
+    }
+    return page;
+}
+
+[[eosio::action, eosio::read_only]] code_page evm_contract::exportcode(uint64_t cursor, uint32_t offset, uint32_t max_bytes) {
+    uint32_t budget = page_budget(max_bytes, code_page_overhead);
+    code_page page;
+
+    account_code_table codes(get_self(), get_self().value);
+    for (auto itr = codes.lower_bound(cursor); itr != codes.end(); ++itr, offset = 0) {
+        const uint32_t code_size = itr->code.size();
+        eosio::check(offset <= code_size, "offset out of range");
+
+        exported_code row{itr->id, itr->code_hash, code_size, offset, {}};
+        // 4 bytes for the length of data
+        const size_t size = eosio::pack_size(row) + 4;
+        if (size >= budget) {
+            eosio::check(!page.codes.empty(), "max_bytes too small");
+            page.next = itr->id;
+            page.next_offset = offset;
+            break;
+        }
+
+        const uint32_t len = std::min<uint32_t>(code_size - offset, budget - size);
+        row.data.assign(itr->code.begin() + offset, itr->code.begin() + offset + len);
+        budget -= size + len;
+        page.codes.emplace_back(std::move(row));
+
+        if (offset + len < code_size) {
+            page.next = itr->id;
+            page.next_offset = offset + len;
+            break;
+        }
+    }
+    return page;
+}
+
+[[eosio::action, eosio::read_only]] storage_page evm_contract::exportstore(uint64_t account_id, uint64_t cursor, uint32_t max_bytes) {
+    uint32_t budget = page_budget(max_bytes, storage_page_overhead);
+    storage_page page;
+
+    storage_table db(get_self(), account_id);
+    for (auto itr = db.lower_bound(cursor); itr != db.end(); ++itr) {
+        exported_slot row{itr->key, itr->value};
+
+        const size_t size = eosio::pack_size(row);
+        if (size > budget) {
+            eosio::check(!page.slots.empty(), "max_bytes too small");
+            page.next = itr->id;
+            break;
+        }
+        budget -= size;
+        page.slots.emplace_back(std::move(row));
+    }
+    return page;
+}
+
+} // namespace evm_runtime
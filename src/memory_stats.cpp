@@ -0,0 +1,113 @@
+#include <cstdlib>
+#include <new>
+
+#include <eosio/print.hpp>
+#include <evm_runtime/memory_stats.hpp>
+
+// End of the static data, defined by the linker
+extern "C" unsigned char __data_end;
+
+namespace evm_runtime::memory_stats {
+
+namespace {
+
+constexpr uint32_t  paint         = 0xa5a5a5a5;
+constexpr uintptr_t paint_margin  = 512; // <- left untouched below the frame of begin() for its own callees
+constexpr uintptr_t paint_limit   = 1024 * 1024; // <- painted below the margin, WITH_LARGE_STACK has 50 MB of stack
+constexpr size_t    alloc_header  = 16;  // <- keeps the alignment of malloc
+
+// Right below every pointer returned by operator new, whatever its alignment
+struct alloc_info {
+    void*  base;
+    size_t size;
+};
+static_assert(sizeof(alloc_info) <= alloc_header);
+
+uint32_t  start_pages     = 0;
+uintptr_t stack_low       = 0;
+uintptr_t paint_end       = 0;
+uintptr_t stack_start     = 0;
+uint64_t  allocations     = 0;
+uint64_t  frees           = 0;
+uint64_t  heap_bytes      = 0;
+uint64_t  peak_heap_bytes = 0;
+
+// Every variant of operator new and delete goes through these two, so that a pointer allocated by one form and freed
+// by another is still accounted for. Alignments above the one of malloc are padded, the header keeps the real base.
+void* counted_alloc(size_t size, size_t align = alloc_header) {
+    const size_t padding = align > alloc_header ? align - 1 : 0;
+    auto* base = static_cast<char*>(std::malloc(size + alloc_header + padding));
+    if (!base) return nullptr;
+    auto* p = base + alloc_header;
+    if (padding) p = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(p) + padding) & ~uintptr_t(align - 1));
+    *(reinterpret_cast<alloc_info*>(p) - 1) = alloc_info{base, size};
+    ++allocations;
+    heap_bytes += size;
+    if (heap_bytes > peak_heap_bytes) peak_heap_bytes = heap_bytes;
+    return p;
+}
+
+void counted_free(void* ptr) {
+    if (!ptr) return;
+    const auto& info = *(static_cast<alloc_info*>(ptr) - 1);
+    ++frees;
+    heap_bytes -= info.size;
+    std::free(info.base);
+}
+
+} // namespace
+
+void begin() {
+    start_pages = __builtin_wasm_memory_size(0);
+
+    // The stack grows down, either from the start of the data (--stack-first) or from the end of the data
+    const auto sp = reinterpret_cast<uintptr_t>(__builtin_frame_address(0));
+    const auto data_end = reinterpret_cast<uintptr_t>(&__data_end);
+    stack_low = sp > data_end ? (data_end + 15) & ~uintptr_t(15) : 16;
+    stack_start = sp;
+    paint_end = sp > stack_low + paint_margin ? (sp - paint_margin) & ~uintptr_t(3) : stack_low;
+    if (paint_end - stack_low > paint_limit) stack_low = paint_end - paint_limit;
+
+    for (auto p = stack_low; p < paint_end; p += sizeof(paint)) {
+        *reinterpret_cast<volatile uint32_t*>(p) = paint;
+    }
+}
+
+void print() {
+    // Deepest word overwritten since begin(), an untouched painted area means the action stayed within the margin and
+    // an overwritten lowest word that it went at least as deep as the painted area
+    auto p = stack_low;
+    while (p < paint_end && *reinterpret_cast<volatile uint32_t*>(p) == paint) p += sizeof(paint);
+    const uint64_t peak_stack = stack_start - (p < paint_end ? p : paint_end);
+
+    const uint32_t pages = __builtin_wasm_memory_size(0);
+    eosio::print("mem_stats: ", pages, " ", pages - start_pages, " ", peak_stack, " ",
+                 allocations, " ", frees, " ", peak_heap_bytes, "\n");
+}
+
+} // namespace evm_runtime::memory_stats
+
+using evm_runtime::memory_stats::counted_alloc;
+using evm_runtime::memory_stats::counted_free;
+
+void* operator new(size_t size) { return counted_alloc(size); }
+void* operator new[](size_t size) { return counted_alloc(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size); }
+void* operator new(size_t size, std::align_val_t align) { return counted_alloc(size, size_t(align)); }
+void* operator new[](size_t size, std::align_val_t align) { return counted_alloc(size, size_t(align)); }
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept { return counted_alloc(size, size_t(align)); }
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept { return counted_alloc(size, size_t(align)); }
+
+void operator delete(void* ptr) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { counted_free(ptr); }
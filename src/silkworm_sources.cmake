@@ -0,0 +1,50 @@
+# ethash, evmone and silkworm sources needed to execute EVM transactions in the contract, shared with the native
+# profiling build (see native/CMakeLists.txt)
+get_filename_component(EVM_ROOT_DIR ${CMAKE_CURRENT_LIST_DIR}/.. ABSOLUTE)
+
+set(SILKWORM_SOURCES "")
+
+# ethash
+list(APPEND SILKWORM_SOURCES 
+    ${EVM_ROOT_DIR}/silkworm/third_party/ethash/lib/keccak/keccak.c
+    ${EVM_ROOT_DIR}/silkworm/third_party/ethash/lib/ethash/ethash.cpp
+    ${EVM_ROOT_DIR}/silkworm/third_party/ethash/lib/ethash/primes.c
+)
+
+# evmone
+list(APPEND SILKWORM_SOURCES 
+    ${EVM_ROOT_DIR}/silkworm/third_party/evmone/lib/evmone/instructions_calls.cpp
+    ${EVM_ROOT_DIR}/silkworm/third_party/evmone/lib/evmone/vm.cpp
+    ${EVM_ROOT_DIR}/silkworm/third_party/evmone/lib/evmone/eof.cpp
+    ${EVM_ROOT_DIR}/silkworm/third_party/evmone/lib/evmone/baseline.cpp
+    ${EVM_ROOT_DIR}/silkworm/third_party/evmone/lib/evmone/baseline_instruction_table.cpp
+    ${EVM_ROOT_DIR}/silkworm/third_party/evmone/lib/evmone/instructions_storage.cpp
+)
+
+# silkworm
+list(APPEND SILKWORM_SOURCES 
+    ${EVM_ROOT_DIR}/silkworm/silkworm/core/common/util.cpp
+    ${EVM_ROOT_DIR}/silkworm/silkworm/core/common/endian.cpp
+    ${EVM_ROOT_DIR}/silkworm/silkworm/core/common/assert.cpp
+    ${EVM_ROOT_DIR}/silkworm/silkworm/core/protocol/rule_set.cpp
+    ${EVM_ROOT_DIR}/silkworm/silkworm/core/protocol/validation.cpp
+    ${EVM_ROOT_DIR}/silkworm/silkworm/core/protocol/intrinsic_gas.cpp
+    ${EVM_ROOT_DIR}/silkworm/silkworm/core/execution/evm.cpp
+    ${EVM_ROOT_DIR}/silkworm/silkworm/core/execution/precompile.cpp
+    ${EVM_ROOT_DIR}/silkworm/silkworm/core/execution/address.cpp
+    ${EVM_ROOT_DIR}/silkworm/silkworm/core/execution/processor.cpp
+    ${EVM_ROOT_DIR}/silkworm/silkworm/core/state/intra_block_state.cpp
+    ${EVM_ROOT_DIR}/silkworm/silkworm/core/state/delta.cpp
+    ${EVM_ROOT_DIR}/silkworm/silkworm/core/types/account.cpp
+    ${EVM_ROOT_DIR}/silkworm/silkworm/core/types/transaction.cpp
+    ${EVM_ROOT_DIR}/silkworm/silkworm/core/types/receipt.cpp
+    ${EVM_ROOT_DIR}/silkworm/silkworm/core/types/block.cpp
+    ${EVM_ROOT_DIR}/silkworm/silkworm/core/types/log.cpp
+    ${EVM_ROOT_DIR}/silkworm/silkworm/core/types/y_parity_and_chain_id.cpp
+    ${EVM_ROOT_DIR}/silkworm/silkworm/core/rlp/encode.cpp
+    ${EVM_ROOT_DIR}/silkworm/silkworm/core/rlp/decode.cpp
+    ${EVM_ROOT_DIR}/silkworm/silkworm/core/crypto/ecdsa.c
+    ${EVM_ROOT_DIR}/silkworm/silkworm/core/crypto/secp256k1n.cpp
+    ${EVM_ROOT_DIR}/silkworm/silkworm/core/chain/config.cpp
+    ${EVM_ROOT_DIR}/silkworm/eosevm/refund_v3.cpp
+)
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <map>
 #include <evm_runtime/tables.hpp>
 #include <evm_runtime/state.hpp>
@@ -20,30 +21,15 @@ std::optional<Account> state::read_account(const evmc::address& address) const n
 
     addr2id[address] = itr->id;
 
-    evmc::bytes32 code_hash;
-    if (itr->code_id) {
-        account_code_table codes(_self, _self.value);
-        auto citr = codes.find(itr->code_id.value());
-        if (citr != codes.end()) {
-            code_hash = to_bytes32(citr->code_hash);
-            addr2code[code_hash] = citr->code;
-        } else {
-            // Should not reach here! 
-            // Return empty hash for robustness.
-            code_hash = silkworm::kEmptyHash;
-        }
-    } else {
-        code_hash = silkworm::kEmptyHash;
-    }
+    const evmc::bytes32 code_hash = itr->code_id ? code_hash_of(itr->code_id.value()) : silkworm::kEmptyHash;
 
     return Account{itr->nonce, intx::be::load<uint256>(itr->get_balance()), code_hash, 0};
 }
 
 ByteView state::read_code(const evmc::bytes32& code_hash) const noexcept {
     
-    if(addr2code.find(code_hash) != addr2code.end()) {
-        const auto& code = addr2code[code_hash];
-        return ByteView{(const uint8_t*)code.data(), code.size()};
+    if(auto itr = addr2code.find(code_hash); itr != addr2code.end()) {
+        return ByteView{(const uint8_t*)itr->second.data(), itr->second.size()};
     }
     
     account_code_table codes(_self, _self.value);
@@ -54,8 +40,8 @@ ByteView state::read_code(const evmc::bytes32& code_hash) const noexcept {
         return ByteView{};
     }
 
-    addr2code[code_hash] = itr->code;
-    const auto& code = addr2code[code_hash];
+    id2codehash[itr->id] = code_hash;
+    const auto& code = addr2code.try_emplace(code_hash, itr->code).first->second;
     return ByteView{(const uint8_t*)code.data(), code.size()};
 }
 
@@ -98,6 +84,13 @@ void state::update_account(const evmc::address& address, std::optional<Account>
     check(!_read_only, "ro state");
     const bool equal{current == initial};
     if(equal) return;
+
+    if (_state_diff) {
+        auto& change = std::get<account_change>(_state_diff->emplace_back(account_change{}));
+        change.address = to_bytes(address);
+        if (current) change.current = account_state{current->nonce, to_bytes(current->balance)};
+        change.reset = current && initial && initial->incarnation != current->incarnation;
+    }
     
     account_table accounts(_self, _self.value);
     auto inx = accounts.get_index<"by.address"_n>();
@@ -112,6 +105,8 @@ void state::update_account(const evmc::address& address, std::optional<Account>
         // Codes are not supposed to changed in this call.
         row.code_id = std::nullopt;
         row.flags = 0;
+        row.storage_slots = 0;
+        if (digest_enabled()) row.storage_digest = bytes(32, 0);
     };
 
     auto update = [&](auto& row) {
@@ -121,13 +116,24 @@ void state::update_account(const evmc::address& address, std::optional<Account>
     };
 
     auto remove_account = [&](auto& itr) {
-        storage_table db(_self, itr->id);
-        // add to garbage collection table for later removal
-        gc_store_table gc(_self, _self.value);
-        gc.emplace(_ram_payer, [&](auto& row){
-            row.id = gc.available_primary_key();
-            row.storage_id = itr->id;
-        });
+        digest_remove_account(*itr);
+
+        std::optional<uint64_t> storage_slots;
+        if (itr->storage_slots.has_value()) {
+            auto ditr = _storage_slot_deltas.find(itr->id);
+            storage_slots = *itr->storage_slots + (ditr != _storage_slot_deltas.end() ? ditr->second : 0);
+        }
+        _storage_slot_deltas.erase(itr->id);
+
+        // add to garbage collection table for later removal, unless the storage is known to be empty
+        if (!storage_slots || *storage_slots > 0) {
+            gc_store_table gc(_self, _self.value);
+            gc.emplace(_ram_payer, [&](auto& row){
+                row.id = gc.available_primary_key();
+                row.storage_id = itr->id;
+                if (storage_slots) row.storage_slots = *storage_slots;
+            });
+        }
         // Remove code if necessary
         if (itr->code_id) {
             account_code_table codes(_self, _self.value);
@@ -137,6 +143,8 @@ void state::update_account(const evmc::address& address, std::optional<Account>
                     row.ref_count--;
                 });
             } else {
+                // the id can be reused by a code created later in this action
+                id2codehash.erase(itrc.id);
                 codes.erase(itrc);
             }
         }
@@ -146,14 +154,16 @@ void state::update_account(const evmc::address& address, std::optional<Account>
 
     if (current.has_value()) {
         if (itr == inx.end()) {
-            accounts.emplace(_ram_payer, emplace);
+            digest_account(*accounts.emplace(_ram_payer, emplace), true);
             ++stats.account.create;
         } else {
             if( initial && initial->incarnation != current->incarnation ) {
                 remove_account(itr);
-                accounts.emplace(_ram_payer, emplace);
+                digest_account(*accounts.emplace(_ram_payer, emplace), true);
             } else {
+                digest_account(*itr, false);
                 accounts.modify(*itr, eosio::same_payer, update);
+                digest_account(*itr, true);
                 ++stats.account.update;
             }
         }
@@ -171,11 +181,20 @@ bool state::gc(uint32_t max) {
     while( max && i != gc.end() ) {
         storage_table db(_self, i->storage_id);
         auto sitr = db.begin();
+        uint64_t erased = 0;
         while( max && sitr != db.end() ) {
             sitr = db.erase(sitr);
             --max;
+            ++erased;
+        }
+        if( !max ) {
+            if( erased && i->storage_slots.has_value() ) {
+                gc.modify(*i, eosio::same_payer, [&](auto& row){
+                    row.storage_slots = *row.storage_slots - std::min(erased, *row.storage_slots);
+                });
+            }
+            break;
         }
-        if( !max ) break;
         i = gc.erase(i);
         --max;
     }
@@ -189,6 +208,11 @@ void state::update_account_code(const evmc::address& address, uint64_t, const ev
     auto inxc = codes.get_index<"by.codehash"_n>();
     auto itrc = inxc.find(make_key(code_hash));
     uint64_t code_id;
+    if (_state_diff) {
+        // followers only need the code the first time they see its hash
+        _state_diff->emplace_back(code_change{to_bytes(address), to_bytes(code_hash), itrc == inxc.end() ? bytes{code.begin(), code.end()} : bytes{}});
+    }
+
     if(itrc == inxc.end()) {
         code_id = codes.available_primary_key();
         codes.emplace(_ram_payer, [&](auto& row){
@@ -204,23 +228,29 @@ void state::update_account_code(const evmc::address& address, uint64_t, const ev
         });
         code_id = itrc->id;
     }
+    id2codehash[code_id] = code_hash;
     
     account_table accounts(_self, _self.value);
     auto inx = accounts.get_index<"by.address"_n>();
     auto itr = inx.find(make_key(address));
     ++stats.account.read;
     if( itr != inx.end() ) {
+        digest_account(*itr, false);
         accounts.modify(*itr, eosio::same_payer, [&](auto& row){
             row.code_id = code_id;
         });
+        digest_account(*itr, true);
         ++stats.account.update;
     } else {
-        accounts.emplace(_ram_payer, [&](auto& row){
+        auto aitr = accounts.emplace(_ram_payer, [&](auto& row){
             row.id = get_next_account_id();;
             row.eth_address = to_bytes(address);
             row.nonce = 0;
             row.code_id = code_id;
+            row.storage_slots = 0;
+            if (digest_enabled()) row.storage_digest = bytes(32, 0);
         });
+        digest_account(*aitr, true);
         ++stats.account.create;
     }
 }
@@ -229,6 +259,10 @@ void state::update_storage(const evmc::address& address, uint64_t incarnation, c
                                    const evmc::bytes32& initial, const evmc::bytes32& current) {
     
     check(!_read_only, "ro state");
+    if (_state_diff) {
+        _state_diff->emplace_back(storage_change{to_bytes(address), to_bytes(location), is_zero(current) ? bytes{} : to_bytes(current)});
+    }
+
     account_table accounts(_self, _self.value);
     auto inx = accounts.get_index<"by.address"_n>();
     auto itr = inx.find(make_key(address));
@@ -241,38 +275,50 @@ void state::update_storage(const evmc::address& address, uint64_t incarnation, c
         auto itr2 = inx2.find(make_key(location));
         ++stats.storage.read;
         if(itr2 == inx2.end()) return;
+        digest_slot(itr->id, itr->eth_address, *itr2, false);
         db.erase(*itr2);
+        --_storage_slot_deltas[itr->id];
         ++stats.storage.remove;
     } else {
         uint64_t table_id;
         if(itr == inx.end()){
-            accounts.emplace(_ram_payer, [&](auto& row){
+            auto aitr = accounts.emplace(_ram_payer, [&](auto& row){
                 table_id = get_next_account_id();
                 row.id = table_id;
                 row.eth_address = to_bytes(address);
                 row.nonce = 0;
                 row.code_id = std::nullopt;
+                row.storage_slots = 0;
+                if (digest_enabled()) row.storage_digest = bytes(32, 0);
             });
+            digest_account(*aitr, true);
             ++stats.account.read;
         } else {
             table_id = itr->id;
         }
+        const bytes address_bytes = to_bytes(address);
 
         storage_table db(_self, table_id);
         auto inx2 = db.get_index<"by.key"_n>();
         auto itr2 = inx2.find(make_key(location));
         ++stats.storage.read;
         if(itr2 == inx2.end()) {
-            db.emplace(_ram_payer, [&](auto& row){
+            auto sitr = db.emplace(_ram_payer, [&](auto& row){
                 row.id = db.available_primary_key();
                 row.key = to_bytes(location);
                 row.value = to_bytes(current);
             });
+            digest_slot(table_id, address_bytes, *sitr, true);
+            ++_storage_slot_deltas[table_id];
             ++stats.storage.create;
         } else {
+            // e.g. a reentrancy guard set and reset within the transaction (1 -> 2 -> 1)
+            if(to_bytes32(itr2->value) == current) return;
+            digest_slot(table_id, address_bytes, *itr2, false);
             db.modify(*itr2, eosio::same_payer, [&](auto& row){
                 row.value = to_bytes(current);
             });
+            digest_slot(table_id, address_bytes, *itr2, true);
             ++stats.storage.update;
         }
     }
@@ -346,7 +392,167 @@ uint64_t state::get_next_account_id() {
     return id;
 }
 
+bool state::digest_enabled() {
+    if(!_digest_enabled) {
+        state_digest_singleton digest(_self, _self.value);
+        _digest_enabled = digest.exists();
+        if (*_digest_enabled) {
+            auto value = digest.get();
+            if (value.seed.has_value()) _digest_seed = value.seed.value();
+        }
+    }
+    return *_digest_enabled;
+}
+
+bool state::digest_covers(uint64_t account_id) {
+    if (!digest_enabled()) return false;
+    return !_digest_seed || account_id < _digest_seed->account_id;
+}
+
+uint256 state::account_leaf(const account& row) const {
+    // 0x01 || address || nonce (8 bytes big endian) || balance || code hash
+    uint8_t buffer[1 + kAddressLength + 8 + 32 + 32] = {0x01};
+    uint8_t* p = buffer + 1;
+    std::copy(row.eth_address.begin(), row.eth_address.end(), p);
+    p += kAddressLength;
+    for (int i = 0; i < 8; ++i) {
+        *p++ = static_cast<uint8_t>(row.nonce >> (56 - 8 * i));
+    }
+    std::copy(row.balance.begin(), row.balance.end(), p);
+    p += 32;
+
+    const evmc::bytes32 code_hash = row.code_id ? code_hash_of(row.code_id.value()) : silkworm::kEmptyHash;
+    std::copy(std::begin(code_hash.bytes), std::end(code_hash.bytes), p);
+
+    return intx::be::load<uint256>(ethash::keccak256(buffer, sizeof(buffer)));
+}
+
+evmc::bytes32 state::code_hash_of(uint64_t code_id) const {
+    if (auto hitr = id2codehash.find(code_id); hitr != id2codehash.end()) {
+        return hitr->second;
+    }
+
+    account_code_table codes(_self, _self.value);
+    auto citr = codes.find(code_id);
+    if (citr == codes.end()) {
+        // Should not reach here!
+        // Return empty hash for robustness.
+        return silkworm::kEmptyHash;
+    }
+    const auto code_hash = to_bytes32(citr->code_hash);
+    id2codehash[code_id] = code_hash;
+    // views returned by read_code point into addr2code, never reassign an entry
+    addr2code.try_emplace(code_hash, citr->code);
+    return code_hash;
+}
+
+uint256 state::account_digest(const account& row) const {
+    uint256 res = account_leaf(row);
+    if (row.storage_digest.has_value()) {
+        res += to_uint256(*row.storage_digest);
+    }
+    auto itr = _storage_digest_deltas.find(row.id);
+    if (itr != _storage_digest_deltas.end()) {
+        res += itr->second;
+    }
+    return res;
+}
+
+void state::digest_account(const account& row, bool add) {
+    if (!digest_covers(row.id)) return;
+    const uint256 leaf = account_leaf(row);
+    _digest_delta = add ? _digest_delta + leaf : _digest_delta - leaf;
+}
+
+uint256 state::slot_leaf(const bytes& address, const bytes& key, const bytes& value) const {
+    // 0x02 || address || key || value
+    uint8_t buffer[1 + kAddressLength + 32 + 32] = {0x02};
+    uint8_t* p = buffer + 1;
+    std::copy(address.begin(), address.end(), p);
+    p += kAddressLength;
+    std::copy(key.begin(), key.end(), p);
+    p += 32;
+    std::copy(value.begin(), value.end(), p);
+    return intx::be::load<uint256>(ethash::keccak256(buffer, sizeof(buffer)));
+}
+
+void state::digest_slot(uint64_t account_id, const bytes& address, const storage& slot, bool add) {
+    if (!digest_covers(account_id)) {
+        // in the account seeddigest is at, rows below its slot cursor go to the partial sum and the others are walked
+        if (!_digest_seed || account_id != _digest_seed->account_id || slot.id >= _digest_seed->slot_id) return;
+        const uint256 leaf = slot_leaf(address, slot.key, slot.value);
+        _seed_digest_delta = add ? _seed_digest_delta + leaf : _seed_digest_delta - leaf;
+        _seed_slot_delta += add ? 1 : -1;
+        return;
+    }
+
+    const uint256 leaf = slot_leaf(address, slot.key, slot.value);
+    auto& account_delta = _storage_digest_deltas[account_id];
+    if (add) {
+        _digest_delta += leaf;
+        account_delta += leaf;
+    } else {
+        _digest_delta -= leaf;
+        account_delta -= leaf;
+    }
+}
+
+void state::digest_remove_account(const account& row) {
+    if (!digest_covers(row.id)) return;
+    // the storage rows are left to gc, their leaves go away with the account
+    _digest_delta -= account_digest(row);
+    _storage_digest_deltas.erase(row.id);
+}
+
+// The slot count and storage digest deltas of an account are applied together, with one write of its row
+void state::flush_account_deltas() {
+    account_table accounts(_self, _self.value);
+    auto slots = _storage_slot_deltas.begin();
+    auto digests = _storage_digest_deltas.begin();
+    while(slots != _storage_slot_deltas.end() || digests != _storage_digest_deltas.end()) {
+        // both maps are ordered by account id
+        uint64_t id;
+        if(slots == _storage_slot_deltas.end()) id = digests->first;
+        else if(digests == _storage_digest_deltas.end()) id = slots->first;
+        else id = std::min(slots->first, digests->first);
+        int64_t slot_delta = 0;
+        uint256 digest_delta = 0;
+        if(slots != _storage_slot_deltas.end() && slots->first == id) slot_delta = (slots++)->second;
+        if(digests != _storage_digest_deltas.end() && digests->first == id) digest_delta = (digests++)->second;
+        if(!slot_delta && !digest_delta) continue;
+
+        auto itr = accounts.find(id);
+        if(itr == accounts.end()) continue;
+        const bool update_slots = slot_delta && itr->storage_slots.has_value();
+        const bool update_digest = digest_delta && itr->storage_digest.has_value();
+        if(!update_slots && !update_digest) continue;
+        accounts.modify(*itr, eosio::same_payer, [&](auto& row){
+            if(update_slots) row.storage_slots = *row.storage_slots + slot_delta;
+            if(update_digest) row.storage_digest = to_bytes(to_uint256(*row.storage_digest) + digest_delta);
+        });
+    }
+    _storage_slot_deltas.clear();
+    _storage_digest_deltas.clear();
+
+    if(_digest_delta || _seed_digest_delta || _seed_slot_delta) {
+        state_digest_singleton digest(_self, _self.value);
+        auto value = digest.get();
+        value.digest = to_bytes(to_uint256(value.digest) + _digest_delta);
+        if(value.seed.has_value()) {
+            auto& seed = value.seed.value();
+            seed.storage_digest = to_bytes(to_uint256(seed.storage_digest) + _seed_digest_delta);
+            seed.storage_slots += _seed_slot_delta;
+        }
+        digest.set(value, _self);
+        _digest_delta = 0;
+        _seed_digest_delta = 0;
+        _seed_slot_delta = 0;
+    }
+}
+
 state::~state() {
+    if(!_storage_slot_deltas.empty() || !_storage_digest_deltas.empty() || _digest_delta || _seed_digest_delta ||
+       _seed_slot_delta) flush_account_deltas();
     if(!_config2.has_value()) return;
     eosio::singleton<"config2"_n, config2> cfg2{_self, _self.value};
     cfg2.set(_config2.value(), _self);
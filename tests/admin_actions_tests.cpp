@@ -4,6 +4,8 @@
 #include <silkworm/core/execution/address.hpp>
 #include "utils.hpp"
 
+#include <ethash/keccak.hpp>
+
 using namespace evm_test;
 using eosio::testing::eosio_assert_message_is;
 using eosio::testing::expect_assert_message;
@@ -401,6 +403,121 @@ BOOST_FIXTURE_TEST_CASE(addevmbal_add_tests, admin_action_tester) try {
 
 } FC_LOG_AND_RETHROW()
 
+BOOST_FIXTURE_TEST_CASE(importstate_tests, admin_action_tester) try {
+
+   // Runtime code: CALLER SELFDESTRUCT
+   const bytes code = to_bytes(evmc::from_hex("33ff").value());
+   const auto hash = ethash::keccak256(reinterpret_cast<const uint8_t*>(code.data()), code.size());
+   const bytes code_hash{reinterpret_cast<const char*>(hash.bytes), reinterpret_cast<const char*>(hash.bytes) + sizeof(hash.bytes)};
+
+   evm_eoa evm1;
+   evm_eoa evm2;
+   evm_eoa evm3;
+   auto word = [](const intx::uint256& v) { return to_bytes(v); };
+
+   state_batch batch;
+   batch.codes.push_back(code);
+   batch.accounts.push_back({to_bytes(evm1.address), 5, word(1_ether), code_hash, {{word(1), word(10)}, {word(2), word(20)}}});
+   batch.accounts.push_back({to_bytes(evm2.address), 0, word(2_ether), code_hash, {}});
+   batch.accounts.push_back({to_bytes(evm3.address), 1, word(0), std::nullopt, {{word(3), word(0)}}});
+
+   BOOST_REQUIRE_EXCEPTION(importstate(batch, std::nullopt, "alice"_n),
+      missing_auth_exception, eosio::testing::fc_exception_message_starts_with("missing authority"));
+
+   BOOST_REQUIRE_EXCEPTION(importstate(batch, fc::sha256::hash(std::string("nope"))),
+      eosio_assert_message_exception, eosio_assert_message_is("checksum mismatch"));
+
+   state_batch no_code = batch;
+   no_code.codes.clear();
+   BOOST_REQUIRE_EXCEPTION(importstate(no_code),
+      eosio_assert_message_exception, eosio_assert_message_is("code not found"));
+
+   state_batch too_large;
+   too_large.accounts.push_back({to_bytes(evm1.address), 0, word(0), std::nullopt, {}});
+   too_large.accounts[0].storage.resize(1000, {word(1), word(1)});
+   BOOST_REQUIRE_EXCEPTION(importstate(too_large),
+      eosio_assert_message_exception, eosio_assert_message_is("batch too large"));
+
+   // Codes count toward the rows of a batch
+   too_large.accounts[0].storage.resize(999);
+   too_large.accounts[0].code_hash = code_hash;
+   too_large.codes.push_back(code);
+   BOOST_REQUIRE_EXCEPTION(importstate(too_large),
+      eosio_assert_message_exception, eosio_assert_message_is("batch too large"));
+
+   state_batch extra_code = batch;
+   extra_code.codes.push_back(to_bytes(evmc::from_hex("00").value()));
+   BOOST_REQUIRE_EXCEPTION(importstate(extra_code),
+      eosio_assert_message_exception, eosio_assert_message_is("code not referenced by the batch"));
+
+   importstate(batch);
+
+   auto a1 = find_account_by_address(evm1.address).value();
+   auto a2 = find_account_by_address(evm2.address).value();
+   auto a3 = find_account_by_address(evm3.address).value();
+   BOOST_REQUIRE_EQUAL(a1.nonce, 5);
+   BOOST_REQUIRE(a1.balance == 1_ether);
+   BOOST_REQUIRE(a2.balance == 2_ether);
+   BOOST_REQUIRE(!a3.code_id.has_value());
+
+   // Both accounts share one code row
+   BOOST_REQUIRE(a1.code_id.has_value() && a1.code_id == a2.code_id);
+   size_t code_rows = 0;
+   scan_account_code([&](account_code row) -> bool {
+      BOOST_REQUIRE(row.code_hash == code_hash);
+      BOOST_REQUIRE_EQUAL(row.ref_count, 2);
+      ++code_rows;
+      return false;
+   });
+   BOOST_REQUIRE_EQUAL(code_rows, 1);
+
+   // Zero values are not stored
+   BOOST_REQUIRE_EQUAL(a1.storage_slots.value(), 2);
+   BOOST_REQUIRE_EQUAL(a3.storage_slots.value(), 0);
+   std::map<intx::uint256, intx::uint256> slots;
+   scan_account_storage(a1.id, [&](storage_slot slot) -> bool {
+      slots[slot.key] = slot.value;
+      return false;
+   });
+   BOOST_REQUIRE(slots == (std::map<intx::uint256, intx::uint256>{{1, 10}, {2, 20}}));
+
+   // A later batch updates existing accounts and slots, known codes do not need to be sent again
+   state_batch update;
+   update.accounts.push_back({to_bytes(evm1.address), 6, word(3_ether), code_hash, {{word(1), word(0)}, {word(2), word(21)}, {word(4), word(40)}}});
+   update.accounts.push_back({to_bytes(evm3.address), 1, word(0), code_hash, {}});
+   importstate(update);
+
+   a1 = find_account_by_address(evm1.address).value();
+   a3 = find_account_by_address(evm3.address).value();
+   BOOST_REQUIRE_EQUAL(a1.nonce, 6);
+   BOOST_REQUIRE(a1.balance == 3_ether);
+   BOOST_REQUIRE(a3.code_id == a1.code_id);
+   BOOST_REQUIRE_EQUAL(a1.storage_slots.value(), 2);
+   slots.clear();
+   scan_account_storage(a1.id, [&](storage_slot slot) -> bool {
+      slots[slot.key] = slot.value;
+      return false;
+   });
+   BOOST_REQUIRE(slots == (std::map<intx::uint256, intx::uint256>{{2, 21}, {4, 40}}));
+
+   // The code of an account cannot be replaced
+   state_batch other_code;
+   other_code.codes.push_back(to_bytes(evmc::from_hex("00").value()));
+   const auto other_hash = ethash::keccak256(reinterpret_cast<const uint8_t*>(other_code.codes[0].data()), 1);
+   other_code.accounts.push_back({to_bytes(evm1.address), 6, word(3_ether),
+      bytes{reinterpret_cast<const char*>(other_hash.bytes), reinterpret_cast<const char*>(other_hash.bytes) + sizeof(other_hash.bytes)}, {}});
+   BOOST_REQUIRE_EXCEPTION(importstate(other_code),
+      eosio_assert_message_exception, eosio_assert_message_is("code mismatch"));
+
+   // The digest stays in sync with the imported state
+   intx::uint256 sum = 0;
+   for (const auto& address : {evm1.address, evm2.address, evm3.address}) {
+      sum += getdigest(address);
+   }
+   BOOST_REQUIRE(sum == getdigest());
+
+} FC_LOG_AND_RETHROW()
+
 BOOST_FIXTURE_TEST_CASE(addopenbal_tests, admin_action_tester) try {
    open("alice"_n);
    transfer_token("alice"_n, evm_account_name, make_asset(100'0000), "alice");
@@ -47,6 +47,7 @@ struct partial_account_table_row
    bytes balance;
    std::optional<uint64_t> code_id;
    uint32_t flags;
+   std::optional<uint64_t> storage_slots;
 };
 
 struct storage_table_row
@@ -69,6 +70,8 @@ namespace fc { namespace raw {
       fc::raw::unpack(ds, tmp.code_id);
       tmp.flags=0;
       if(ds.remaining()) { fc::raw::unpack(ds, tmp.flags); }
+      tmp.storage_slots.reset();
+      if(ds.remaining()) { uint64_t storage_slots; fc::raw::unpack(ds, storage_slots); tmp.storage_slots = storage_slots; }
     } FC_RETHROW_EXCEPTIONS(warn, "error unpacking partial_account_table_row") }
 
      template<>
@@ -113,6 +116,16 @@ namespace fc { namespace raw {
          fc::raw::unpack(ds, prices);
          tmp.gas_prices.emplace(prices);
       }
+      if(ds.remaining()) {
+         uint32_t gc_budget;
+         fc::raw::unpack(ds, gc_budget);
+         tmp.gc_budget.emplace(gc_budget);
+      }
+      if(ds.remaining()) {
+         evm_test::block_gas_params block_gas;
+         fc::raw::unpack(ds, block_gas);
+         tmp.block_gas.emplace(block_gas);
+      }
 
     } FC_RETHROW_EXCEPTIONS(warn, "error unpacking partial_account_table_row") }
 }}
@@ -262,6 +275,12 @@ transaction_trace_ptr basic_evm_tester::migratebal(name from_name, int limit) {
       evm_account_name, "migratebal"_n, evm_account_name, mvo()("from_name", from_name)("limit",limit));
 }
 
+transaction_trace_ptr basic_evm_tester::migratenonce(name from_name, int limit) {
+
+   return push_action(
+      evm_account_name, "migratenonce"_n, evm_account_name, mvo()("from_name", from_name)("limit",limit));
+}
+
 transaction_trace_ptr basic_evm_tester::transfer_token(name from, name to, asset quantity, std::string memo, name acct)
 {
    return push_action(
@@ -508,12 +527,15 @@ transaction_trace_ptr basic_evm_tester::admincall(const evmc::bytes& from, const
    return push_action(evm_account_name, "admincall"_n, actor,  mvo()("from", from_bytes)("to", to_bytes)("value", value_bytes)("data", data_bytes)("gas_limit", gas_limit));
 }
 
-transaction_trace_ptr basic_evm_tester::bridgereg(name receiver, name handler, asset min_fee, vector<account_name> extra_signers) {
+transaction_trace_ptr basic_evm_tester::bridgereg(name receiver, name handler, asset min_fee, vector<account_name> extra_signers, std::optional<uint32_t> flags) {
    extra_signers.push_back(receiver);
    if (receiver != handler)
       extra_signers.push_back(handler);
-   return basic_evm_tester::push_action(evm_account_name, "bridgereg"_n, extra_signers, 
-      mvo()("receiver", receiver)("handler", handler)("min_fee", min_fee));
+   auto args = mvo()("receiver", receiver)("handler", handler)("min_fee", min_fee);
+   if (flags.has_value()) {
+      args("flags", *flags);
+   }
+   return basic_evm_tester::push_action(evm_account_name, "bridgereg"_n, extra_signers, args);
 }
 
 transaction_trace_ptr basic_evm_tester::bridgeunreg(name receiver) {
@@ -521,6 +543,11 @@ transaction_trace_ptr basic_evm_tester::bridgeunreg(name receiver) {
       mvo()("receiver", receiver));
 }
 
+transaction_trace_ptr basic_evm_tester::pullmsgs(name receiver, uint32_t max, name actor) {
+   return basic_evm_tester::push_action(evm_account_name, "pullmsgs"_n, actor,
+      mvo()("receiver", receiver)("max", max));
+}
+
 transaction_trace_ptr basic_evm_tester::assertnonce(name account, uint64_t next_nonce) {
    return basic_evm_tester::push_action(evm_account_name, "assertnonce"_n, account, 
       mvo()("account", account)("next_nonce", next_nonce));
@@ -597,6 +624,16 @@ transaction_trace_ptr basic_evm_tester::addopenbal(name account, const intx::uin
       mvo()("account", account)("delta",d)("subtract",subtract));
 }
 
+transaction_trace_ptr basic_evm_tester::resetdigest(name actor) {
+   return basic_evm_tester::push_action(evm_account_name, "resetdigest"_n, actor, mvo());
+}
+
+transaction_trace_ptr basic_evm_tester::importstate(const state_batch& batch, std::optional<fc::sha256> checksum, name actor) {
+   if (!checksum) checksum = fc::sha256::hash(fc::raw::pack(batch));
+   return basic_evm_tester::push_action(evm_account_name, "importstate"_n, actor,
+      mvo()("checksum", *checksum)("batch", batch));
+}
+
 transaction_trace_ptr basic_evm_tester::setgasprices(const gas_prices_type& prices, name actor) {
    return basic_evm_tester::push_action(evm_account_name, "setgasprices"_n, actor,
       mvo()("prices", prices));
@@ -642,6 +679,27 @@ void basic_evm_tester::withdraw(name owner, asset quantity)
    push_action(evm_account_name, "withdraw"_n, owner, mvo()("owner", owner)("quantity", quantity));
 }
 
+transaction_trace_ptr basic_evm_tester::withdrawmany(name owner, const std::vector<std::pair<name, asset>>& payouts)
+{
+   fc::variants v;
+   for (const auto& [to, quantity] : payouts) {
+      v.emplace_back(mvo()("first", to)("second", quantity));
+   }
+   return push_action(evm_account_name, "withdrawmany"_n, owner, mvo()("owner", owner)("payouts", v));
+}
+
+transaction_trace_ptr basic_evm_tester::bridgemany(name owner, const std::vector<std::pair<evmc::address, asset>>& credits)
+{
+   fc::variants v;
+   for (const auto& [to, quantity] : credits) {
+      bytes to_bytes;
+      to_bytes.resize(sizeof(to.bytes));
+      memcpy(to_bytes.data(), to.bytes, sizeof(to.bytes));
+      v.emplace_back(mvo()("first", to_bytes)("second", quantity));
+   }
+   return push_action(evm_account_name, "bridgemany"_n, owner, mvo()("owner", owner)("credits", v));
+}
+
 balance_and_dust basic_evm_tester::inevm() const {
    return fc::raw::unpack<balance_and_dust>(get_row_by_account(evm_account_name, evm_account_name, "inevm"_n, "inevm"_n));
 }
@@ -650,6 +708,61 @@ void basic_evm_tester::gc(uint32_t max) {
    push_action(evm_account_name, "gc"_n, evm_account_name, mvo()("max", max));
 }
 
+storage_top_page basic_evm_tester::topstorage(uint64_t cursor, uint32_t scan, uint32_t max) {
+   auto trace = push_action(evm_account_name, "topstorage"_n, evm_account_name,
+      mvo()("cursor", cursor)("scan", scan)("max", max));
+   return fc::raw::unpack<storage_top_page>(trace->action_traces[0].return_value);
+}
+
+std::vector<block_gas> basic_evm_tester::getblockgas() {
+   auto trace = push_action(evm_account_name, "getblockgas"_n, evm_account_name, mvo());
+   return fc::raw::unpack<std::vector<block_gas>>(trace->action_traces[0].return_value);
+}
+
+intx::uint256 basic_evm_tester::getdigest(const std::optional<evmc::address>& address) {
+   fc::variant address_v;
+   if (address) {
+      address_v = bytes{std::begin(address->bytes), std::end(address->bytes)};
+   }
+   auto trace = push_action(evm_account_name, "getdigest"_n, evm_account_name, mvo()("address", address_v));
+   auto digest = fc::raw::unpack<bytes>(trace->action_traces[0].return_value);
+   BOOST_REQUIRE(digest.size() == 32);
+   return intx::be::unsafe::load<intx::uint256>(reinterpret_cast<const uint8_t*>(digest.data()));
+}
+
+bool basic_evm_tester::seeddigest(uint32_t max) {
+   auto trace = push_action(evm_account_name, "seeddigest"_n, evm_account_name, mvo()("max", max));
+   return fc::raw::unpack<bool>(trace->action_traces[0].return_value);
+}
+
+account_page basic_evm_tester::exportaccts(uint64_t cursor, uint32_t max_bytes) {
+   auto trace = push_action(evm_account_name, "exportaccts"_n, evm_account_name, mvo()("cursor", cursor)("max_bytes", max_bytes));
+   return fc::raw::unpack<account_page>(trace->action_traces[0].return_value);
+}
+
+code_page basic_evm_tester::exportcode(uint64_t cursor, uint32_t offset, uint32_t max_bytes) {
+   auto trace = push_action(evm_account_name, "exportcode"_n, evm_account_name, mvo()("cursor", cursor)("offset", offset)("max_bytes", max_bytes));
+   return fc::raw::unpack<code_page>(trace->action_traces[0].return_value);
+}
+
+storage_page basic_evm_tester::exportstore(uint64_t account_id, uint64_t cursor, uint32_t max_bytes) {
+   auto trace = push_action(evm_account_name, "exportstore"_n, evm_account_name, mvo()("account_id", account_id)("cursor", cursor)("max_bytes", max_bytes));
+   return fc::raw::unpack<storage_page>(trace->action_traces[0].return_value);
+}
+
+transaction_trace_ptr basic_evm_tester::setgcbudget(uint32_t budget, name actor) {
+   return push_action(evm_account_name, "setgcbudget"_n, actor, mvo()("budget", budget));
+}
+
+transaction_trace_ptr basic_evm_tester::setblockgas(uint64_t soft_cap, uint32_t max_base_fee_multiplier, name actor) {
+   return push_action(evm_account_name, "setblockgas"_n, actor,
+      mvo()("soft_cap", soft_cap)("max_base_fee_multiplier", max_base_fee_multiplier));
+}
+
+transaction_trace_ptr basic_evm_tester::setstatediff(bool enabled, name actor) {
+   return push_action(evm_account_name, "setstatediff"_n, actor, mvo()("enabled", enabled));
+}
+
 balance_and_dust basic_evm_tester::vault_balance(name owner) const
 {
    const vector<char> d = get_row_by_account(evm_account_name, evm_account_name, "balances"_n, owner);
@@ -694,7 +807,8 @@ std::optional<account_object> convert_to_account_object(const partial_account_ta
       .nonce = row.nonce,
       .balance = intx::be::unsafe::load<intx::uint256>(reinterpret_cast<const uint8_t*>(row.balance.data())),
       .code_id = row.code_id,
-      .flags = row.flags
+      .flags = row.flags,
+      .storage_slots = row.storage_slots
    };
 }
 
@@ -860,6 +974,17 @@ bool basic_evm_tester::scan_account_code(std::function<bool(account_code)> visit
    return true;
 }
 
+bool basic_evm_tester::scan_message_queue(name receiver, std::function<bool(queued_message)> visitor) const
+{
+   static constexpr eosio::chain::name message_queue_table_name = "msgqueue"_n;
+
+   scan_table<queued_message>(
+      message_queue_table_name, receiver, [&visitor](queued_message&& row) { return visitor(row); }
+   );
+
+   return true;
+}
+
 bool basic_evm_tester::scan_price_queue(std::function<bool(price_queue)> visitor) const
 {
    static constexpr eosio::chain::name price_queue_table_name = "pricequeue"_n;
@@ -68,8 +68,36 @@ struct evmtx_v3 : evmtx_base {
    uint64_t storage_price;
 };
 
+struct account_state {
+   uint64_t nonce;
+   bytes    balance;
+};
+
+struct account_change {
+   bytes                        address;
+   std::optional<account_state> current;
+   bool                         reset;
+};
+
+struct code_change {
+   bytes address;
+   bytes code_hash;
+   bytes code;
+};
 
-using evmtx_type = std::variant<evmtx_v1, evmtx_v3>;
+struct storage_change {
+   bytes address;
+   bytes key;
+   bytes value;
+};
+
+using state_change = std::variant<account_change, code_change, storage_change>;
+
+struct evmtx_v4 : evmtx_v3 {
+   std::vector<state_change> state_diff;
+};
+
+using evmtx_type = std::variant<evmtx_v1, evmtx_v3, evmtx_v4>;
 
 struct transfer_data {
    name  from;
@@ -116,6 +144,11 @@ struct gas_prices_type {
     }
 };
 
+struct block_gas_params {
+   uint64_t soft_cap = 0;
+   uint32_t max_base_fee_multiplier = 0;
+};
+
 struct config_table_row
 {
    unsigned_int version;
@@ -131,6 +164,8 @@ struct config_table_row
    std::optional<uint32_t> queue_front_block;
    std::optional<uint64_t> ingress_gas_limit;
    std::optional<gas_prices_type> gas_prices;
+   std::optional<uint32_t> gc_budget;
+   std::optional<block_gas_params> block_gas;
 };
 
 struct config2_table_row
@@ -168,6 +203,7 @@ struct account_object
    intx::uint256 balance;
    std::optional<uint64_t> code_id;
    std::optional<uint32_t> flags;
+   std::optional<uint64_t> storage_slots;
 
    inline bool has_flag(flag f)const {
       return (flags.has_value() && (flags.value() & static_cast<uint32_t>(f)) != 0);
@@ -208,6 +244,80 @@ struct exec_output {
    std::optional<bytes> context;
 };
 
+struct block_gas {
+   uint64_t         block_num;
+   uint64_t         gas_used;
+   uint64_t         base_fee;
+   balance_and_dust gas_fee_income;
+   balance_and_dust ingress_bridge_fee_income;
+};
+
+struct account_storage {
+   uint64_t id;
+   bytes    eth_address;
+   uint64_t storage_slots;
+};
+
+struct storage_top_page {
+   std::vector<account_storage> accounts;
+   std::optional<uint64_t>      next;
+};
+
+struct exported_account {
+   uint64_t id;
+   bytes    address;
+   uint64_t nonce;
+   bytes    balance;
+   bytes    code_hash;
+};
+
+struct account_page {
+   std::vector<exported_account> accounts;
+   std::optional<uint64_t>       next;
+};
+
+struct exported_code {
+   uint64_t id;
+   bytes    code_hash;
+   uint32_t size;
+   uint32_t offset;
+   bytes    data;
+};
+
+struct code_page {
+   std::vector<exported_code> codes;
+   std::optional<uint64_t>    next;
+   uint32_t                   next_offset;
+};
+
+struct exported_slot {
+   bytes key;
+   bytes value;
+};
+
+struct storage_page {
+   std::vector<exported_slot> slots;
+   std::optional<uint64_t>    next;
+};
+
+struct imported_slot {
+   bytes key;
+   bytes value;
+};
+
+struct imported_account {
+   bytes                      address;
+   uint64_t                   nonce;
+   bytes                      balance;
+   std::optional<bytes>       code_hash;
+   std::vector<imported_slot> storage;
+};
+
+struct state_batch {
+   std::vector<bytes>            codes;
+   std::vector<imported_account> accounts;
+};
+
 struct message_receiver {
     name     account;
     name     handler;
@@ -237,6 +347,11 @@ struct account_code {
 
 using bridge_message = std::variant<bridge_message_v0>;
 
+struct queued_message {
+   uint64_t       id;
+   bridge_message message;
+};
+
 struct price_queue {
    uint64_t block;
    uint64_t price;
@@ -264,14 +379,33 @@ FC_REFLECT(evm_test::fee_parameters, (gas_price)(miner_cut)(ingress_bridge_fee))
 FC_REFLECT(evm_test::exec_input, (context)(from)(to)(data)(value))
 FC_REFLECT(evm_test::exec_callback, (contract)(action))
 FC_REFLECT(evm_test::exec_output, (status)(data)(context))
+FC_REFLECT(evm_test::block_gas_params, (soft_cap)(max_base_fee_multiplier))
+FC_REFLECT(evm_test::block_gas, (block_num)(gas_used)(base_fee)(gas_fee_income)(ingress_bridge_fee_income))
+FC_REFLECT(evm_test::account_storage, (id)(eth_address)(storage_slots))
+FC_REFLECT(evm_test::storage_top_page, (accounts)(next))
+FC_REFLECT(evm_test::exported_account, (id)(address)(nonce)(balance)(code_hash))
+FC_REFLECT(evm_test::account_page, (accounts)(next))
+FC_REFLECT(evm_test::exported_code, (id)(code_hash)(size)(offset)(data))
+FC_REFLECT(evm_test::code_page, (codes)(next)(next_offset))
+FC_REFLECT(evm_test::exported_slot, (key)(value))
+FC_REFLECT(evm_test::storage_page, (slots)(next))
+FC_REFLECT(evm_test::imported_slot, (key)(value))
+FC_REFLECT(evm_test::imported_account, (address)(nonce)(balance)(code_hash)(storage))
+FC_REFLECT(evm_test::state_batch, (codes)(accounts))
 
 FC_REFLECT(evm_test::message_receiver, (account)(handler)(min_fee)(flags));
 FC_REFLECT(evm_test::bridge_message_v0, (receiver)(sender)(timestamp)(value)(data));
+FC_REFLECT(evm_test::queued_message, (id)(message));
 FC_REFLECT(evm_test::gcstore, (id)(storage_id));
 FC_REFLECT(evm_test::account_code, (id)(ref_count)(code)(code_hash));
 FC_REFLECT(evm_test::evmtx_base, (eos_evm_version)(rlptx));
 FC_REFLECT_DERIVED(evm_test::evmtx_v1, (evm_test::evmtx_base), (base_fee_per_gas));
 FC_REFLECT_DERIVED(evm_test::evmtx_v3, (evm_test::evmtx_base), (overhead_price)(storage_price));
+FC_REFLECT(evm_test::account_state, (nonce)(balance));
+FC_REFLECT(evm_test::account_change, (address)(current)(reset));
+FC_REFLECT(evm_test::code_change, (address)(code_hash)(code));
+FC_REFLECT(evm_test::storage_change, (address)(key)(value));
+FC_REFLECT_DERIVED(evm_test::evmtx_v4, (evm_test::evmtx_v3), (state_diff));
 FC_REFLECT(evm_test::transfer_data, (from)(to)(quantity)(memo));
 
 FC_REFLECT(evm_test::consensus_parameter_type, (current)(pending));
@@ -448,6 +582,7 @@ public:
    transaction_trace_ptr transfer_token(name from, name to, asset quantity, std::string memo = "", name acct=token_account_name);
    transaction_trace_ptr swapgastoken();
    transaction_trace_ptr migratebal(name from_name, int limit);
+   transaction_trace_ptr migratenonce(name from_name, int limit);
 
    action get_action( account_name code, action_name acttype, vector<permission_level> auths,
                                  const bytes& data )const;
@@ -491,8 +626,9 @@ public:
    silkworm::Transaction
    generate_tx(const evmc::address& to, const intx::uint256& value, uint64_t gas_limit = 21000) const;
 
-   transaction_trace_ptr bridgereg(name receiver, name handler, asset min_fee, vector<account_name> extra_signers={evm_account_name});
+   transaction_trace_ptr bridgereg(name receiver, name handler, asset min_fee, vector<account_name> extra_signers={evm_account_name}, std::optional<uint32_t> flags={});
    transaction_trace_ptr bridgeunreg(name receiver);
+   transaction_trace_ptr pullmsgs(name receiver, uint32_t max, name actor);
    transaction_trace_ptr exec(const exec_input& input, const std::optional<exec_callback>& callback);
    transaction_trace_ptr assertnonce(name account, uint64_t next_nonce);
    transaction_trace_ptr pushtx(const silkworm::Transaction& trx, name miner = evm_account_name, std::optional<uint64_t> min_inclusion_price={});
@@ -517,15 +653,30 @@ public:
    transaction_trace_ptr freezeaccnt(uint64_t id, bool value, name actor=evm_account_name);
    transaction_trace_ptr addevmbal(uint64_t id, const intx::uint256& delta, bool subtract, name actor=evm_account_name);
    transaction_trace_ptr addopenbal(name account, const intx::uint256& delta, bool subtract, name actor=evm_account_name);
+   transaction_trace_ptr resetdigest(name actor=evm_account_name);
+   // checksum defaults to the sha256 of the packed batch
+   transaction_trace_ptr importstate(const state_batch& batch, std::optional<fc::sha256> checksum = std::nullopt, name actor=evm_account_name);
 
    transaction_trace_ptr setgasprices(const gas_prices_type& prices, name actor=evm_account_name);
+   transaction_trace_ptr setgcbudget(uint32_t budget, name actor=evm_account_name);
+   transaction_trace_ptr setblockgas(uint64_t soft_cap, uint32_t max_base_fee_multiplier, name actor=evm_account_name);
+   transaction_trace_ptr setstatediff(bool enabled, name actor=evm_account_name);
 
    void open(name owner);
    void close(name owner);
    void withdraw(name owner, asset quantity);
+   transaction_trace_ptr withdrawmany(name owner, const std::vector<std::pair<name, asset>>& payouts);
+   transaction_trace_ptr bridgemany(name owner, const std::vector<std::pair<evmc::address, asset>>& credits);
 
    balance_and_dust inevm() const;
    void gc(uint32_t max);
+   storage_top_page topstorage(uint64_t cursor, uint32_t scan, uint32_t max);
+   std::vector<block_gas> getblockgas();
+   intx::uint256 getdigest(const std::optional<evmc::address>& address = std::nullopt);
+   bool seeddigest(uint32_t max);
+   account_page exportaccts(uint64_t cursor, uint32_t max_bytes);
+   code_page exportcode(uint64_t cursor, uint32_t offset, uint32_t max_bytes);
+   storage_page exportstore(uint64_t account_id, uint64_t cursor, uint32_t max_bytes);
    balance_and_dust vault_balance(name owner) const;
    std::optional<intx::uint256> evm_balance(const evmc::address& address) const;
    std::optional<intx::uint256> evm_balance(const evm_eoa& account) const;
@@ -567,6 +718,7 @@ public:
    bool scan_account_storage(uint64_t account_id, std::function<bool(storage_slot)> visitor) const;
    bool scan_gcstore(std::function<bool(gcstore)> visitor) const;
    bool scan_account_code(std::function<bool(account_code)> visitor) const;
+   bool scan_message_queue(name receiver, std::function<bool(queued_message)> visitor) const;
    void scan_balances(std::function<bool(evm_test::vault_balance_row)> visitor) const;
    bool scan_price_queue(std::function<bool(evm_test::price_queue)> visitor) const;
    bool scan_prices_queue(std::function<bool(evm_test::prices_queue)> visitor) const;
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+
+#include "basic_evm_tester.hpp"
+
+// Benchmark suites are tagged with the "bench" label and disabled by default so that they do not slow down the
+// regular unit test runs. Run them explicitly with:
+//    ./unit_test --run_test=@bench -- --eos-vm-oc
+#define EVM_BENCH_DECORATORS *boost::unit_test::label("bench") * boost::unit_test::disabled()
+
+namespace evm_test {
+
+// Printed by contracts built with WITH_MEMORY_STATS, see include/evm_runtime/memory_stats.hpp
+struct memory_stats {
+   uint64_t pages           = 0;
+   uint64_t grown_pages     = 0;
+   uint64_t stack_bytes     = 0;
+   uint64_t allocations     = 0;
+   uint64_t frees           = 0;
+   uint64_t peak_heap_bytes = 0;
+};
+
+// Largest values over the actions of the transaction, nullopt when the contract was built without WITH_MEMORY_STATS
+inline std::optional<memory_stats> parse_memory_stats(const transaction_trace_ptr& trace) {
+   static constexpr std::string_view prefix = "mem_stats: ";
+   std::optional<memory_stats> res;
+   for (const auto& at : trace->action_traces) {
+      const auto pos = at.console.find(prefix);
+      if (pos == std::string::npos) continue;
+      std::istringstream in(at.console.substr(pos + prefix.size()));
+      memory_stats m;
+      in >> m.pages >> m.grown_pages >> m.stack_bytes >> m.allocations >> m.frees >> m.peak_heap_bytes;
+      if (!in) continue;
+      if (!res) res.emplace();
+      res->pages           = std::max(res->pages, m.pages);
+      res->grown_pages     = std::max(res->grown_pages, m.grown_pages);
+      res->stack_bytes     = std::max(res->stack_bytes, m.stack_bytes);
+      res->allocations     = std::max(res->allocations, m.allocations);
+      res->frees           = std::max(res->frees, m.frees);
+      res->peak_heap_bytes = std::max(res->peak_heap_bytes, m.peak_heap_bytes);
+   }
+   return res;
+}
+
+struct bench_sample {
+   std::string name;
+   uint64_t    cpu_usage_us = 0;   // billed CPU from the transaction receipt
+   int64_t     elapsed_us   = 0;   // wall clock time spent applying the transaction
+   size_t      actions      = 0;   // number of action traces, including inline actions
+   uint64_t    gas_used     = 0;   // optional, filled in by the benchmark when known
+   std::optional<memory_stats> memory; // WITH_MEMORY_STATS builds only
+};
+
+inline bench_sample make_bench_sample(std::string name, const transaction_trace_ptr& trace, uint64_t gas_used = 0) {
+   BOOST_REQUIRE(trace);
+   BOOST_REQUIRE(trace->receipt.has_value());
+   return bench_sample{
+      .name         = std::move(name),
+      .cpu_usage_us = trace->receipt->cpu_usage_us,
+      .elapsed_us   = trace->elapsed.count(),
+      .actions      = trace->action_traces.size(),
+      .gas_used     = gas_used,
+      .memory       = parse_memory_stats(trace),
+   };
+}
+
+// Init code returning runtime as the code of the new contract: <prelude>; codecopy(0, offset, size); return(0, size)
+// The prelude runs first as the constructor, it must leave the stack empty and not return.
+inline silkworm::Bytes make_init_code(const silkworm::Bytes& runtime, const silkworm::Bytes& prelude = {}) {
+   const size_t offset = prelude.size() + 15;
+   BOOST_REQUIRE(runtime.size() <= 0xffff && offset <= 0xffff);
+   const uint8_t size_hi = static_cast<uint8_t>(runtime.size() >> 8);
+   const uint8_t size_lo = static_cast<uint8_t>(runtime.size());
+   const uint8_t offset_hi = static_cast<uint8_t>(offset >> 8);
+   const uint8_t offset_lo = static_cast<uint8_t>(offset);
+   silkworm::Bytes res{0x61, size_hi, size_lo, 0x61, offset_hi, offset_lo, 0x60, 0x00, 0x39, 0x61, size_hi, size_lo, 0x60, 0x00, 0xf3};
+   return prelude + res + runtime;
+}
+
+// calldatacopy(0, 0, calldatasize); loop: <body>; jump loop
+// Repeats a stack neutral body until the transaction runs out of gas, so the whole gas limit is billed.
+inline silkworm::Bytes make_gas_loop(const silkworm::Bytes& body) {
+   silkworm::Bytes res = evmc::from_hex("3660006000375b").value();
+   res += body;
+   res += evmc::from_hex("61000656").value();
+   return res;
+}
+
+// Runtime of a minimal token: transfer(to, amount), balances being a solidity mapping at slot 0
+inline constexpr const char* token_runtime = "33600052600060205260406000208054602435808210603057808203835560043560005260406000208054820190550"
+                                             "05b600080fd";
+// Constructor prelude of the token: balances[caller] = 2^128 - 1
+inline constexpr const char* token_mint = "6fffffffffffffffffffffffffffffffff336000526000602052604060002055";
+
+inline evmc::bytes32 token_balance_slot(const evmc::address& owner) {
+   uint8_t buffer[64] = {};
+   std::memcpy(buffer + 12, owner.bytes, sizeof(owner.bytes));
+   const auto h = ethash::keccak256(buffer, sizeof(buffer));
+   evmc::bytes32 res;
+   std::memcpy(res.bytes, h.bytes, sizeof(res.bytes));
+   return res;
+}
+
+inline silkworm::Bytes token_transfer_data(const evmc::address& to, uint64_t amount) {
+   silkworm::Bytes data = evmc::from_hex("a9059cbb").value(); // sha3(transfer(address,uint256))[:4]
+   data += silkworm::to_bytes32(to);
+   data += evmc::bytes32{amount};
+   return data;
+}
+
+// Push an EVM transaction and measure it, gas_used being derived from the balance of the sender. A transaction
+// rejected by the chain (e.g. over the CPU limit) is reported with its error instead of failing the benchmark.
+inline bench_sample measure_call(basic_evm_tester& t, evm_eoa& eoa, std::string name, const evmc::address& to,
+                                 const silkworm::Bytes& data, uint64_t gas_limit) {
+   const auto gas_price = t.get_gas_price();
+   auto txn = t.generate_tx(to, 0, gas_limit);
+   txn.data = data;
+   eoa.sign(txn);
+
+   const auto pre = t.evm_balance(eoa);
+   bench_sample sample{.name = name};
+   try {
+      sample = make_bench_sample(std::move(name), t.pushtx(txn));
+      sample.gas_used = static_cast<uint64_t>((*pre - *t.evm_balance(eoa)) / gas_price);
+   } catch (const fc::exception& e) {
+      sample.name += " (" + e.top_message() + ")";
+      eoa.next_nonce--;
+   }
+   return sample;
+}
+
+struct bench_report {
+   explicit bench_report(std::string title) : title(std::move(title)) {}
+
+   bench_sample& add(bench_sample s) {
+      samples.emplace_back(std::move(s));
+      return samples.back();
+   }
+
+   void print(std::ostream& os = std::cout) const {
+      const bool with_memory = std::any_of(samples.begin(), samples.end(), [](const auto& s) { return s.memory.has_value(); });
+      os << "\n== " << title << " ==\n";
+      os << std::left << std::setw(40) << "case"
+         << std::right << std::setw(12) << "cpu_us"
+         << std::setw(12) << "elapsed_us"
+         << std::setw(10) << "actions"
+         << std::setw(12) << "gas"
+         << std::setw(14) << "ns/gas";
+      if (with_memory) {
+         os << std::setw(8) << "pages" << std::setw(8) << "grown" << std::setw(10) << "stack_b"
+            << std::setw(8) << "allocs" << std::setw(12) << "heap_b";
+      }
+      os << "\n";
+      for (const auto& s : samples) {
+         os << std::left << std::setw(40) << s.name
+            << std::right << std::setw(12) << s.cpu_usage_us
+            << std::setw(12) << s.elapsed_us
+            << std::setw(10) << s.actions
+            << std::setw(12) << s.gas_used;
+         if (s.gas_used) {
+            os << std::setw(14) << std::fixed << std::setprecision(3) << (s.elapsed_us * 1000.0 / s.gas_used);
+         } else {
+            os << std::setw(14) << "-";
+         }
+         if (s.memory) {
+            os << std::setw(8) << s.memory->pages << std::setw(8) << s.memory->grown_pages
+               << std::setw(10) << s.memory->stack_bytes << std::setw(8) << s.memory->allocations
+               << std::setw(12) << s.memory->peak_heap_bytes;
+         } else if (with_memory) {
+            os << std::setw(8) << "-" << std::setw(8) << "-" << std::setw(10) << "-" << std::setw(8) << "-"
+               << std::setw(12) << "-";
+         }
+         os << "\n";
+      }
+      os.flush();
+   }
+
+   std::string               title;
+   std::vector<bench_sample> samples;
+};
+
+} // namespace evm_test
@@ -0,0 +1,252 @@
+#include <boost/test/unit_test.hpp>
+
+#include "basic_evm_tester.hpp"
+
+using namespace evm_test;
+using eosio::testing::eosio_assert_message_is;
+
+struct block_gas_tester : basic_evm_tester {
+
+   evm_eoa evm1;
+   evm_eoa evm2;
+
+   block_gas_tester() {
+      create_accounts({"alice"_n});
+      transfer_token(faucet_account_name, "alice"_n, make_asset(10000'0000));
+      init();
+      transfer_token("alice"_n, evm_account_name, make_asset(1000'0000), evm1.address_0x());
+      transfer_token("alice"_n, evm_account_name, make_asset(1'0000), evm2.address_0x());
+      produce_block();
+   }
+
+   uint64_t evm_block_num() const {
+      eosevm::block_mapping bm(get_config().genesis_time.sec_since_epoch());
+      return bm.timestamp_to_evm_block_num(control->pending_block_time().time_since_epoch().count());
+   }
+
+   // Produce blocks until the pending block starts a new EVM block
+   void next_evm_block() {
+      const auto current = evm_block_num();
+      while (evm_block_num() == current) {
+         produce_block();
+      }
+   }
+
+   // Plain value transfer to an existing account: 21000 gas
+   transaction_trace_ptr transfer(uint64_t gas_price) {
+      auto txn = generate_tx(evm2.address, 1, 21'000);
+      txn.max_priority_fee_per_gas = gas_price;
+      txn.max_fee_per_gas = gas_price;
+      evm1.sign(txn);
+      try {
+         return pushtx(txn);
+      } catch (...) {
+         evm1.next_nonce--;
+         throw;
+      }
+   }
+
+   transaction_trace_ptr transfer() { return transfer(get_gas_price()); }
+
+   block_gas current_block_gas() {
+      auto rows = getblockgas();
+      BOOST_REQUIRE(!rows.empty());
+      BOOST_REQUIRE_EQUAL(rows.back().block_num, evm_block_num());
+      return rows.back();
+   }
+};
+
+BOOST_AUTO_TEST_SUITE(block_gas_tests)
+
+BOOST_FIXTURE_TEST_CASE(setblockgas_checks, block_gas_tester) try {
+   BOOST_REQUIRE_EXCEPTION(setblockgas(100'000, 0, "alice"_n),
+                           missing_auth_exception, eosio::testing::fc_exception_message_starts_with("missing authority"));
+
+   BOOST_REQUIRE_EXCEPTION(setblockgas(0, 2),
+                           eosio_assert_message_exception, eosio_assert_message_is("dynamic base fee requires a soft cap"));
+   BOOST_REQUIRE_EXCEPTION(setblockgas(100'000, 2),
+                           eosio_assert_message_exception, eosio_assert_message_is("dynamic base fee requires evm_version >= 1"));
+
+   setblockgas(100'000, 0);
+   auto cfg = get_config();
+   BOOST_REQUIRE(cfg.block_gas.has_value());
+   BOOST_CHECK_EQUAL(cfg.block_gas->soft_cap, 100'000);
+   BOOST_CHECK_EQUAL(cfg.block_gas->max_base_fee_multiplier, 0);
+
+   // Nothing is tracked while the soft cap is 0
+   setblockgas(0, 0);
+   produce_block();
+   transfer();
+   BOOST_CHECK(getblockgas().empty());
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(soft_cap, block_gas_tester) try {
+   setblockgas(50'000, 0);
+   next_evm_block();
+
+   transfer();
+   transfer();
+   transfer(); // <- 42000 gas used so far, still under the soft cap
+   BOOST_REQUIRE_EXCEPTION(transfer(),
+                           eosio_assert_message_exception, eosio_assert_message_is("block gas soft cap reached"));
+
+   // Bridge transactions are never rejected, but they are counted
+   transfer_token("alice"_n, evm_account_name, make_asset(1'0000), evm2.address_0x());
+
+   auto row = current_block_gas();
+   BOOST_CHECK_EQUAL(row.gas_used, 4 * 21'000);
+   BOOST_CHECK_EQUAL(row.base_fee, 0);
+
+   // The next EVM block starts from 0
+   next_evm_block();
+   transfer();
+   BOOST_CHECK_EQUAL(current_block_gas().gas_used, 21'000);
+} FC_LOG_AND_RETHROW()
+
+// From evm_version 1 on the bridge transactions are processed in the action receiving the tokens, not in an inline
+// pushtx: they must still get past the soft cap
+BOOST_FIXTURE_TEST_CASE(soft_cap_evm_version_1, block_gas_tester) try {
+   setversion(1, evm_account_name);
+   produce_blocks(2);
+   transfer_token("alice"_n, evm_account_name, make_asset(1'0000), evm2.address_0x()); // <- activates version 1
+   open("alice"_n);
+   transfer_token("alice"_n, evm_account_name, make_asset(100'0000), "alice");
+   produce_block();
+
+   setblockgas(50'000, 0);
+   next_evm_block();
+
+   transfer();
+   transfer();
+   transfer();
+   BOOST_REQUIRE_EXCEPTION(transfer(),
+                           eosio_assert_message_exception, eosio_assert_message_is("block gas soft cap reached"));
+
+   // Calls of native accounts are user transactions as well
+   evmc::bytes to(std::begin(evm2.address.bytes), std::end(evm2.address.bytes));
+   evmc::bytes value(32, 0);
+   evmc::bytes data;
+   BOOST_REQUIRE_EXCEPTION(call("alice"_n, to, value, data, 21'000, "alice"_n),
+                           eosio_assert_message_exception, eosio_assert_message_is("block gas soft cap reached"));
+
+   // Deposits and bridgemany go through, and are counted
+   const auto balance = *evm_balance(evm2);
+   transfer_token("alice"_n, evm_account_name, make_asset(1'0000), evm2.address_0x());
+   bridgemany("alice"_n, {{evm2.address, make_asset(1'0000)}, {evm1.address, make_asset(1'0000)}});
+   BOOST_CHECK(*evm_balance(evm2) > balance);
+   BOOST_CHECK_EQUAL(current_block_gas().gas_used, 6 * 21'000);
+
+   BOOST_REQUIRE_EXCEPTION(transfer(),
+                           eosio_assert_message_exception, eosio_assert_message_is("block gas soft cap reached"));
+} FC_LOG_AND_RETHROW()
+
+// While block gas is tracked the fee income of an EVM block stays in its row, which every transaction writes anyway,
+// and the statistics singleton is written once, by the first transaction of a later block
+BOOST_FIXTURE_TEST_CASE(fee_income_per_block, block_gas_tester) try {
+   setversion(1, evm_account_name);
+   produce_blocks(2);
+   transfer_token("alice"_n, evm_account_name, make_asset(1'0000), evm2.address_0x()); // <- activates version 1
+   produce_block();
+
+   setblockgas(1'000'000, 0);
+   next_evm_block();
+
+   const auto before = get_statistics();
+   const auto ingress_fee = get_config().ingress_bridge_fee;
+   const intx::uint256 fee = intx::uint256{21'000} * get_gas_price(); // <- base fee of a transfer
+   transfer();
+   transfer();
+   transfer();
+   transfer_token("alice"_n, evm_account_name, make_asset(1'0000), evm2.address_0x());
+
+   BOOST_CHECK(get_statistics().gas_fee_income == before.gas_fee_income);
+   BOOST_CHECK(get_statistics().ingress_bridge_fee_income == before.ingress_bridge_fee_income);
+   auto row = current_block_gas();
+   BOOST_CHECK(static_cast<intx::uint256>(row.gas_fee_income) == fee * 3);
+   BOOST_CHECK_EQUAL(row.ingress_bridge_fee_income.balance, ingress_fee);
+
+   next_evm_block();
+   transfer();
+   auto after = get_statistics();
+   BOOST_CHECK(static_cast<intx::uint256>(after.gas_fee_income) == static_cast<intx::uint256>(before.gas_fee_income) + fee * 3);
+   BOOST_CHECK_EQUAL(after.ingress_bridge_fee_income.balance, before.ingress_bridge_fee_income.balance + ingress_fee);
+
+   auto rows = getblockgas();
+   BOOST_REQUIRE_GE(rows.size(), 2);
+   BOOST_CHECK(static_cast<intx::uint256>(rows[rows.size() - 2].gas_fee_income) == 0);
+   BOOST_CHECK(static_cast<intx::uint256>(rows.back().gas_fee_income) == fee);
+
+   // Turning tracking off moves what is left
+   setblockgas(0, 0);
+   after = get_statistics();
+   BOOST_CHECK(static_cast<intx::uint256>(after.gas_fee_income) == static_cast<intx::uint256>(before.gas_fee_income) + fee * 4);
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(rolling_window, block_gas_tester) try {
+   setblockgas(1'000'000, 0);
+
+   for (int i = 0; i < 12; ++i) {
+      next_evm_block();
+      transfer();
+   }
+   auto rows = getblockgas();
+   BOOST_REQUIRE(!rows.empty());
+   BOOST_CHECK_LE(rows.size(), 8);
+   BOOST_CHECK_EQUAL(rows.back().block_num, evm_block_num());
+   BOOST_CHECK_GT(rows.front().block_num + 8, rows.back().block_num);
+   for (const auto& r : rows) {
+      BOOST_CHECK_EQUAL(r.gas_used, 21'000);
+   }
+
+   // Turning tracking off drops the rows
+   setblockgas(0, 0);
+   produce_block();
+   BOOST_CHECK(getblockgas().empty());
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(dynamic_base_fee, block_gas_tester) try {
+   setversion(1, evm_account_name);
+   produce_blocks(2);
+   transfer_token("alice"_n, evm_account_name, make_asset(1'0000), evm2.address_0x()); // <- activates version 1
+   produce_block();
+
+   const uint64_t floor = get_gas_price();
+   setblockgas(42'000, 4); // <- target of 21000 gas per EVM block
+
+   // Two transfers per block: twice the target
+   next_evm_block();
+   transfer();
+   transfer();
+   auto row = current_block_gas();
+   BOOST_CHECK_EQUAL(row.gas_used, 42'000);
+   BOOST_CHECK_EQUAL(row.base_fee, floor);
+
+   next_evm_block();
+   const uint64_t raised = floor + floor / 8;
+   BOOST_REQUIRE_EXCEPTION(transfer(floor), eosio_assert_message_exception,
+                           eosio_assert_message_is("pre_validate_transaction error: 25 Max fee per gas less than block base fee"));
+
+   const auto balance = *evm_balance(evm1);
+   transfer(raised);
+   BOOST_CHECK_EQUAL(balance - *evm_balance(evm1), 1 + intx::uint256{21'000} * raised);
+   BOOST_CHECK_EQUAL(current_block_gas().base_fee, raised);
+
+   // Empty EVM blocks bring it back to the admin price
+   produce_blocks(40);
+   transfer(floor);
+   row = current_block_gas();
+   BOOST_CHECK_EQUAL(row.gas_used, 21'000);
+   BOOST_CHECK_EQUAL(row.base_fee, floor);
+
+   // Sustained load never pushes it over max_base_fee_multiplier times the admin price
+   for (int i = 0; i < 16; ++i) {
+      next_evm_block();
+      transfer(4 * floor);
+      transfer(4 * floor);
+   }
+   next_evm_block();
+   transfer(4 * floor);
+   BOOST_CHECK_EQUAL(current_block_gas().base_fee, 4 * floor);
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
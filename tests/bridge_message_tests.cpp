@@ -52,12 +52,26 @@ struct bridge_message_tester : basic_evm_tester {
       return ss.str();
     }
 
-    transaction_trace_ptr send_bridge_message(evm_eoa& eoa, const std::string& receiver, const intx::uint256& value, const std::string& str_data) {
+    // // SPDX-License-Identifier: GPL-3.0
+    // pragma solidity >=0.7.0 <0.9.0;
+    // contract Emiter {
+    //     function go(string memory destination, bool force_atomic, uint256 n) public {
+    //         address eosevm = 0xBbBBbbBBbBbbbBBBbBbbBBbB56E4000000000000;
+    //         for(uint i=0; i<n; i++) {
+    //             bytes memory n_bytes = abi.encodePacked(i+0xFFFFFF00);
+    //             (bool success, ) = eosevm.call(abi.encodeWithSignature("bridgeMsgV0(string,bool,bytes)", destination, force_atomic, n_bytes));
+    //             if(!success) { revert(); }
+    //         }
+    //     }
+    // }
+    static constexpr const char* emiter_bytecode = "608060405234801561001057600080fd5b50610696806100206000396000f3fe608060405234801561001057600080fd5b506004361061002b5760003560e01c8063e1963a3114610030575b600080fd5b61004a6004803603810190610045919061038f565b61004c565b005b600073bbbbbbbbbbbbbbbbbbbbbbbb56e4000000000000905060005b828110156101c057600063ffffff0082610082919061042d565b6040516020016100929190610482565b604051602081830303815290604052905060008373ffffffffffffffffffffffffffffffffffffffff168787846040516024016100d193929190610580565b6040516020818303038152906040527ff781185b000000000000000000000000000000000000000000000000000000007bffffffffffffffffffffffffffffffffffffffffffffffffffffffff19166020820180517bffffffffffffffffffffffffffffffffffffffffffffffffffffffff838183161783525050505060405161015b9190610601565b6000604051808303816000865af19150503d8060008114610198576040519150601f19603f3d011682016040523d82523d6000602084013e61019d565b606091505b50509050806101ab57600080fd5b505080806101b890610618565b915050610068565b5050505050565b6000604051905090565b600080fd5b600080fd5b600080fd5b600080fd5b6000601f19601f8301169050919050565b7f4e487b7100000000000000000000000000000000000000000000000000000000600052604160045260246000fd5b61022e826101e5565b810181811067ffffffffffffffff8211171561024d5761024c6101f6565b5b80604052505050565b60006102606101c7565b905061026c8282610225565b919050565b600067ffffffffffffffff82111561028c5761028b6101f6565b5b610295826101e5565b9050602081019050919050565b82818337600083830152505050565b60006102c46102bf84610271565b610256565b9050828152602081018484840111156102e0576102df6101e0565b5b6102eb8482856102a2565b509392505050565b600082601f830112610308576103076101db565b5b81356103188482602086016102b1565b91505092915050565b60008115159050919050565b61033681610321565b811461034157600080fd5b50565b6000813590506103538161032d565b92915050565b6000819050919050565b61036c81610359565b811461037757600080fd5b50565b60008135905061038981610363565b92915050565b6000806000606084860312156103a8576103a76101d1565b5b600084013567ffffffffffffffff8111156103c6576103c56101d6565b5b6103d2868287016102f3565b93505060206103e386828701610344565b92505060406103f48682870161037a565b9150509250925092565b7f4e487b7100000000000000000000000000000000000000000000000000000000600052601160045260246000fd5b600061043882610359565b915061044383610359565b925082820190508082111561045b5761045a6103fe565b5b92915050565b6000819050919050565b61047c61047782610359565b610461565b82525050565b600061048e828461046b565b60208201915081905092915050565b600081519050919050565b600082825260208201905092915050565b60005b838110156104d75780820151818401526020810190506104bc565b60008484015250505050565b60006104ee8261049d565b6104f881856104a8565b93506105088185602086016104b9565b610511816101e5565b840191505092915050565b61052581610321565b82525050565b600081519050919050565b600082825260208201905092915050565b60006105528261052b565b61055c8185610536565b935061056c8185602086016104b9565b610575816101e5565b840191505092915050565b6000606082019050818103600083015261059a81866104e3565b90506105a9602083018561051c565b81810360408301526105bb8184610547565b9050949350505050565b600081905092915050565b60006105db8261052b565b6105e581856105c5565b93506105f58185602086016104b9565b80840191505092915050565b600061060d82846105d0565b915081905092915050565b600061062382610359565b91507fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff8203610655576106546103fe565b5b60018201905091905056fea2646970667358221220b0b317b0ac391546d4bac13af7b3c9e21e5b5ca2c091dbd21a971f492f8adaaa64736f6c63430008120033";
+
+    transaction_trace_ptr send_bridge_message(evm_eoa& eoa, const std::string& receiver, const intx::uint256& value, const std::string& str_data, bool force_atomic = true) {
 
       silkworm::Bytes data;
       data += evmc::from_hex(bridgeMsgV0_method_id).value();
       data += evmc::from_hex(int_str32(96)).value();                     //offset param1 (receiver: string)
-      data += evmc::from_hex(int_str32(1)).value();                      //param2 (true) (force_atomic: bool)
+      data += evmc::from_hex(int_str32(force_atomic)).value();           //param2 (force_atomic: bool)
       data += evmc::from_hex(int_str32(160)).value();                    //offset param3 (data: bytes)
       data += evmc::from_hex(int_str32(receiver.length())).value();      //param1 length
       data += evmc::from_hex(data_str32(str_to_hex(receiver))).value();  //param1 data
@@ -330,20 +344,6 @@ BOOST_FIXTURE_TEST_CASE(test_bridge_errors, bridge_message_tester) try {
 } FC_LOG_AND_RETHROW()
 
 BOOST_FIXTURE_TEST_CASE(test_send_message_from_solidity, bridge_message_tester) try {
-  // // SPDX-License-Identifier: GPL-3.0
-  // pragma solidity >=0.7.0 <0.9.0;
-  // contract Emiter {
-  //     function go(string memory destination, bool force_atomic, uint256 n) public {
-  //         address eosevm = 0xBbBBbbBBbBbbbBBBbBbbBBbB56E4000000000000;
-  //         for(uint i=0; i<n; i++) {
-  //             bytes memory n_bytes = abi.encodePacked(i+0xFFFFFF00);
-  //             (bool success, ) = eosevm.call(abi.encodeWithSignature("bridgeMsgV0(string,bool,bytes)", destination, force_atomic, n_bytes));
-  //             if(!success) { revert(); }
-  //         }
-  //     }
-  // }
-  const std::string emiter_bytecode = "608060405234801561001057600080fd5b50610696806100206000396000f3fe608060405234801561001057600080fd5b506004361061002b5760003560e01c8063e1963a3114610030575b600080fd5b61004a6004803603810190610045919061038f565b61004c565b005b600073bbbbbbbbbbbbbbbbbbbbbbbb56e4000000000000905060005b828110156101c057600063ffffff0082610082919061042d565b6040516020016100929190610482565b604051602081830303815290604052905060008373ffffffffffffffffffffffffffffffffffffffff168787846040516024016100d193929190610580565b6040516020818303038152906040527ff781185b000000000000000000000000000000000000000000000000000000007bffffffffffffffffffffffffffffffffffffffffffffffffffffffff19166020820180517bffffffffffffffffffffffffffffffffffffffffffffffffffffffff838183161783525050505060405161015b9190610601565b6000604051808303816000865af19150503d8060008114610198576040519150601f19603f3d011682016040523d82523d6000602084013e61019d565b606091505b50509050806101ab57600080fd5b505080806101b890610618565b915050610068565b5050505050565b6000604051905090565b600080fd5b600080fd5b600080fd5b600080fd5b6000601f19601f8301169050919050565b7f4e487b7100000000000000000000000000000000000000000000000000000000600052604160045260246000fd5b61022e826101e5565b810181811067ffffffffffffffff8211171561024d5761024c6101f6565b5b80604052505050565b60006102606101c7565b905061026c8282610225565b919050565b600067ffffffffffffffff82111561028c5761028b6101f6565b5b610295826101e5565b9050602081019050919050565b82818337600083830152505050565b60006102c46102bf84610271565b610256565b9050828152602081018484840111156102e0576102df6101e0565b5b6102eb8482856102a2565b509392505050565b600082601f830112610308576103076101db565b5b81356103188482602086016102b1565b91505092915050565b60008115159050919050565b61033681610321565b811461034157600080fd5b50565b6000813590506103538161032d565b92915050565b6000819050919050565b61036c81610359565b811461037757600080fd5b50565b60008135905061038981610363565b92915050565b6000806000606084860312156103a8576103a76101d1565b5b600084013567ffffffffffffffff8111156103c6576103c56101d6565b5b6103d2868287016102f3565b93505060206103e386828701610344565b92505060406103f48682870161037a565b9150509250925092565b7f4e487b7100000000000000000000000000000000000000000000000000000000600052601160045260246000fd5b600061043882610359565b915061044383610359565b925082820190508082111561045b5761045a6103fe565b5b92915050565b6000819050919050565b61047c61047782610359565b610461565b82525050565b600061048e828461046b565b60208201915081905092915050565b600081519050919050565b600082825260208201905092915050565b60005b838110156104d75780820151818401526020810190506104bc565b60008484015250505050565b60006104ee8261049d565b6104f881856104a8565b93506105088185602086016104b9565b610511816101e5565b840191505092915050565b61052581610321565b82525050565b600081519050919050565b600082825260208201905092915050565b60006105528261052b565b61055c8185610536565b935061056c8185602086016104b9565b610575816101e5565b840191505092915050565b6000606082019050818103600083015261059a81866104e3565b90506105a9602083018561051c565b81810360408301526105bb8184610547565b9050949350505050565b600081905092915050565b60006105db8261052b565b6105e581856105c5565b93506105f58185602086016104b9565b80840191505092915050565b600061060d82846105d0565b915081905092915050565b600061062382610359565b91507fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff8203610655576106546103fe565b5b60018201905091905056fea2646970667358221220b0b317b0ac391546d4bac13af7b3c9e21e5b5ca2c091dbd21a971f492f8adaaa64736f6c63430008120033";
-
   // Create destination account
   create_accounts({"rec1"_n});
   set_code("rec1"_n, testing::contracts::evm_bridge_receiver_wasm());
@@ -448,4 +448,254 @@ BOOST_FIXTURE_TEST_CASE(handler_tests, bridge_message_tester) try {
 
 } FC_LOG_AND_RETHROW()
 
-BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
+BOOST_FIXTURE_TEST_CASE(batch_delivery_tests, bridge_message_tester) try {
+
+  create_accounts({"rec1"_n, "rec2"_n});
+
+  // Only known flags can be requested
+  BOOST_REQUIRE_EXCEPTION(bridgereg("rec1"_n, "rec1"_n, make_asset(0), {evm_account_name}, 0x80),
+    eosio_assert_message_exception, eosio_assert_message_is("invalid flags"));
+
+  // rec1 wants its messages in batch (FORCE_ATOMIC is always set), rec2 one by one
+  bridgereg("rec1"_n, "rec1"_n, make_asset(0), {evm_account_name}, 0x2);
+  bridgereg("rec2"_n, "rec2"_n, make_asset(0));
+
+  auto row = fc::raw::unpack<message_receiver>(get_row_by_account( evm_account_name, evm_account_name, "msgreceiver"_n, "rec1"_n));
+  BOOST_REQUIRE(row.flags == 0x3);
+
+  // Fund evm1 address with 100 EOS
+  evm_eoa evm1;
+  transfer_token("alice"_n, evm_account_name, make_asset(100'0000), evm1.address_0x());
+
+  auto contract_addr = deploy_contract(evm1, evmc::from_hex(emiter_bytecode).value());
+  produce_blocks(1);
+
+  auto go = [&](const std::string& destination, uint32_t n) {
+    auto txn = generate_tx(contract_addr, 0, 1'000'000);
+    txn.data  = evmc::from_hex("e1963a31").value();
+    txn.data += evmc::from_hex(int_str32(96)).value(); //offset of param1
+    txn.data += evmc::from_hex(int_str32(1)).value();  //param2
+    txn.data += evmc::from_hex(int_str32(n)).value();  //param3
+    txn.data += evmc::from_hex(int_str32(destination.size())).value(); //param1 size
+    txn.data += evmc::from_hex(data_str32(str_to_hex(destination))).value(); //param1 data
+    evm1.sign(txn);
+    return pushtx(txn);
+  };
+
+  // go('rec1', true, 5) => a single onbridgemsgs action carrying the five messages in order
+  auto res = go("rec1", 5);
+  BOOST_REQUIRE(res->action_traces.size() == 2);
+  BOOST_CHECK(res->action_traces[1].act.account == "rec1"_n);
+  BOOST_CHECK(res->action_traces[1].act.name == "onbridgemsgs"_n);
+
+  auto msgs = fc::raw::unpack<std::vector<bridge_message>>(res->action_traces[1].act.data);
+  BOOST_REQUIRE(msgs.size() == 5);
+  for(size_t i=0; i<msgs.size(); ++i) {
+    const auto& out = std::get<bridge_message_v0>(msgs[i]);
+    BOOST_CHECK(out.receiver == "rec1"_n);
+    BOOST_CHECK(out.sender == to_bytes(contract_addr));
+    BOOST_CHECK(out.value == to_bytes(0_ether));
+    BOOST_CHECK(out.data == to_bytes(evmc::from_hex("00000000000000000000000000000000000000000000000000000000FFFFFF0"+std::to_string(i)).value()));
+  }
+  produce_blocks(1);
+
+  // go('rec2', true, 3) => unchanged behavior, one onbridgemsg per message
+  res = go("rec2", 3);
+  BOOST_REQUIRE(res->action_traces.size() == 4);
+  for(int i=0; i<3; ++i) {
+    BOOST_CHECK(res->action_traces[1+i].act.name == "onbridgemsg"_n);
+    auto out = std::get<bridge_message_v0>(fc::raw::unpack<bridge_message>(res->action_traces[1+i].act.data));
+    BOOST_CHECK(out.receiver == "rec2"_n);
+  }
+
+  // Registering again without flags turns batching off
+  bridgereg("rec1"_n, "rec1"_n, make_asset(0));
+  row = fc::raw::unpack<message_receiver>(get_row_by_account( evm_account_name, evm_account_name, "msgreceiver"_n, "rec1"_n));
+  BOOST_REQUIRE(row.flags == 0x1);
+  produce_blocks(1);
+
+  res = go("rec1", 2);
+  BOOST_REQUIRE(res->action_traces.size() == 3);
+  BOOST_CHECK(res->action_traces[1].act.name == "onbridgemsg"_n);
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(batch_delivery_value_tests, bridge_message_tester) try {
+
+  create_accounts({"rec1"_n});
+  bridgereg("rec1"_n, "rec1"_n, make_asset(1'0000), {evm_account_name}, 0x2);
+
+  // Fund evm1 address with 100 EOS
+  evm_eoa evm1;
+  transfer_token("alice"_n, evm_account_name, make_asset(100'0000), evm1.address_0x());
+
+  // A single message (sent by an EOA) is also delivered through onbridgemsgs
+  auto res = send_bridge_message(evm1, "rec1", 2_ether, "0102");
+  BOOST_REQUIRE(res->action_traces.size() == 2);
+  BOOST_CHECK(res->action_traces[1].act.name == "onbridgemsgs"_n);
+
+  auto msgs = fc::raw::unpack<std::vector<bridge_message>>(res->action_traces[1].act.data);
+  BOOST_REQUIRE(msgs.size() == 1);
+  BOOST_CHECK(std::get<bridge_message_v0>(msgs[0]).value == to_bytes(2_ether));
+
+  // Value is credited to the receiver
+  BOOST_REQUIRE(vault_balance("rec1"_n) == (balance_and_dust{make_asset(2'0000), 0}));
+
+  // min_fee is still enforced per message
+  BOOST_REQUIRE_EXCEPTION(send_bridge_message(evm1, "rec1", 1_finney, "0102"),
+    eosio_assert_message_exception, eosio_assert_message_is("min_fee not covered"));
+  evm1.next_nonce--;
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(async_delivery_tests, bridge_message_tester) try {
+
+  create_accounts({"rec1"_n, "bob"_n});
+  bridgereg("rec1"_n, "rec1"_n, make_asset(1'0000), {evm_account_name}, 0x4);
+
+  auto row = fc::raw::unpack<message_receiver>(get_row_by_account( evm_account_name, evm_account_name, "msgreceiver"_n, "rec1"_n));
+  BOOST_REQUIRE(row.flags == 0x5);
+
+  // Fund evm1 address with 100 EOS
+  evm_eoa evm1;
+  transfer_token("alice"_n, evm_account_name, make_asset(100'0000), evm1.address_0x());
+
+  auto queue_size = [&]() {
+    size_t n = 0;
+    scan_message_queue("rec1"_n, [&](queued_message&&) -> bool { ++n; return false; });
+    return n;
+  };
+
+  // Nothing to pull yet
+  BOOST_REQUIRE_EXCEPTION(pullmsgs("rec1"_n, 10, "bob"_n),
+    eosio_assert_message_exception, eosio_assert_message_is("no queued messages"));
+
+  // Atomic messages are still delivered inline
+  auto res = send_bridge_message(evm1, "rec1", 1_ether, "01");
+  BOOST_REQUIRE(res->action_traces.size() == 2);
+  BOOST_CHECK(res->action_traces[1].act.name == "onbridgemsg"_n);
+  BOOST_REQUIRE(queue_size() == 0);
+
+  // min_fee is enforced when the message is queued
+  BOOST_REQUIRE_EXCEPTION(send_bridge_message(evm1, "rec1", 1_finney, "02", false),
+    eosio_assert_message_exception, eosio_assert_message_is("min_fee not covered"));
+  evm1.next_nonce--;
+
+  // Non-atomic messages are queued, value is credited right away
+  for (int i = 0; i < 3; ++i) {
+    res = send_bridge_message(evm1, "rec1", 2_ether, "0"+std::to_string(i+2), false);
+    BOOST_REQUIRE(res->action_traces.size() == 1);
+  }
+  BOOST_REQUIRE(queue_size() == 3);
+  BOOST_REQUIRE(vault_balance("rec1"_n) == (balance_and_dust{make_asset(7'0000), 0}));
+
+  // The receiver can not unregister while there are pending messages
+  BOOST_REQUIRE_EXCEPTION(bridgeunreg("rec1"_n),
+    eosio_assert_message_exception, eosio_assert_message_is("message queue is not empty"));
+
+  // Anyone can pull, messages are delivered in order
+  res = pullmsgs("rec1"_n, 2, "bob"_n);
+  BOOST_REQUIRE(res->action_traces.size() == 3);
+  for (int i = 0; i < 2; ++i) {
+    BOOST_CHECK(res->action_traces[1+i].act.account == "rec1"_n);
+    BOOST_CHECK(res->action_traces[1+i].act.name == "onbridgemsg"_n);
+    auto out = std::get<bridge_message_v0>(fc::raw::unpack<bridge_message>(res->action_traces[1+i].act.data));
+    BOOST_CHECK(out.sender == to_bytes(evm1.address));
+    BOOST_CHECK(out.value == to_bytes(2_ether));
+    BOOST_CHECK(out.data == to_bytes(evmc::from_hex("0"+std::to_string(i+2)).value()));
+  }
+  BOOST_CHECK(fc::raw::unpack<bool>(res->action_traces[0].return_value) == false);
+  BOOST_REQUIRE(queue_size() == 1);
+  produce_blocks(1);
+
+  // Batch receivers get the pulled messages in a single onbridgemsgs
+  bridgereg("rec1"_n, "rec1"_n, make_asset(1'0000), {evm_account_name}, 0x6);
+  res = pullmsgs("rec1"_n, 10, "bob"_n);
+  BOOST_REQUIRE(res->action_traces.size() == 2);
+  BOOST_CHECK(res->action_traces[1].act.name == "onbridgemsgs"_n);
+  auto msgs = fc::raw::unpack<std::vector<bridge_message>>(res->action_traces[1].act.data);
+  BOOST_REQUIRE(msgs.size() == 1);
+  BOOST_CHECK(std::get<bridge_message_v0>(msgs[0]).data == to_bytes(evmc::from_hex("04").value()));
+  BOOST_CHECK(fc::raw::unpack<bool>(res->action_traces[0].return_value) == true);
+  BOOST_REQUIRE(queue_size() == 0);
+
+  bridgeunreg("rec1"_n);
+  BOOST_REQUIRE_EXCEPTION(pullmsgs("rec1"_n, 10, "bob"_n),
+    eosio_assert_message_exception, eosio_assert_message_is("receiver not registered"));
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(async_queue_bounded_tests, bridge_message_tester) try {
+
+  // Same bounds as in the contract (types.hpp)
+  constexpr uint32_t max_queued_messages = 256;
+  constexpr uint32_t max_queued_message_size = 1024;
+
+  create_accounts({"rec1"_n, "bob"_n});
+  bridgereg("rec1"_n, "rec1"_n, make_asset(0), {evm_account_name}, 0x4);
+
+  evm_eoa evm1;
+  transfer_token("alice"_n, evm_account_name, make_asset(100'0000), evm1.address_0x());
+  auto contract_addr = deploy_contract(evm1, evmc::from_hex(emiter_bytecode).value());
+  produce_blocks(1);
+
+  // go('rec1', false, n): n non-atomic messages, all queued
+  auto go = [&](uint32_t n) {
+    auto txn = generate_tx(contract_addr, 0, 5'000'000);
+    txn.data  = evmc::from_hex("e1963a31").value();
+    txn.data += evmc::from_hex(int_str32(96)).value(); //offset of param1
+    txn.data += evmc::from_hex(int_str32(0)).value();  //param2
+    txn.data += evmc::from_hex(int_str32(n)).value();  //param3
+    txn.data += evmc::from_hex(int_str32(4)).value();  //param1 size
+    txn.data += evmc::from_hex(data_str32(str_to_hex("rec1"))).value(); //param1 data
+    evm1.sign(txn);
+    return pushtx(txn);
+  };
+
+  auto queue_size = [&]() {
+    size_t n = 0;
+    scan_message_queue("rec1"_n, [&](queued_message&&) -> bool { ++n; return false; });
+    return n;
+  };
+
+  auto ram_usage = [&]() {
+    return control->get_resource_limits_manager().get_account_ram_usage(evm_account_name);
+  };
+
+  // Messages with more data than a queue row may hold are rejected
+  BOOST_REQUIRE_EXCEPTION(send_bridge_message(evm1, "rec1", 0, std::string(2 * (max_queued_message_size + 1), 'a'), false),
+    eosio_assert_message_exception, eosio_assert_message_is("bridge message too large to be queued"));
+  evm1.next_nonce--;
+
+  // Flood the queue up to its bound
+  const auto ram_before = ram_usage();
+  for (uint32_t i = 0; i < max_queued_messages / 64; ++i) {
+    go(64);
+    produce_blocks(1);
+  }
+  BOOST_REQUIRE_EQUAL(queue_size(), max_queued_messages);
+  const auto ram_full = ram_usage();
+  BOOST_REQUIRE_GT(ram_full, ram_before);
+  BOOST_REQUIRE_LT(ram_full - ram_before, max_queued_messages * 512);
+
+  // Any further message is rejected, the RAM of the contract does not grow anymore
+  for (uint32_t n : {1, 64}) {
+    BOOST_REQUIRE_EXCEPTION(go(n),
+      eosio_assert_message_exception, eosio_assert_message_is("message queue of receiver is full"));
+    evm1.next_nonce--;
+    produce_blocks(1);
+  }
+  BOOST_REQUIRE_EQUAL(queue_size(), max_queued_messages);
+  BOOST_REQUIRE_EQUAL(ram_usage(), ram_full);
+
+  // Pulling makes room again
+  pullmsgs("rec1"_n, 10, "bob"_n);
+  go(10);
+  BOOST_REQUIRE_EQUAL(queue_size(), max_queued_messages);
+  BOOST_REQUIRE_EXCEPTION(go(1),
+    eosio_assert_message_exception, eosio_assert_message_is("message queue of receiver is full"));
+  evm1.next_nonce--;
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
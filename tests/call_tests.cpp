@@ -1049,4 +1049,84 @@ BOOST_FIXTURE_TEST_CASE(call_other_payer_function, call_evm_tester) try {
 } FC_LOG_AND_RETHROW()
 
 
-BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
+BOOST_FIXTURE_TEST_CASE(nonce_in_balances_row, call_evm_tester) try {
+  auto has_nextnonce_row = [&](name owner) {
+    return !get_row_by_account(evm_account_name, evm_account_name, "nextnonces"_n, owner).empty();
+  };
+
+  open("alice"_n);
+  transfer_token("alice"_n, evm_account_name, make_asset(1000000), "alice");
+
+  // Opened accounts keep their nonce next to their balance
+  BOOST_REQUIRE(!has_nextnonce_row("alice"_n));
+  assertnonce("alice"_n, 0);
+
+  evmc::bytes32 v;
+  auto to = evmc::bytes();
+  auto data = evmc::from_hex(contract_bytecode);
+  call("alice"_n, to, silkworm::Bytes(v), *data, 1000000, "alice"_n); // nonce 0->1
+  assertnonce("alice"_n, 1);
+  BOOST_REQUIRE(!has_nextnonce_row("alice"_n));
+
+  // Nothing left to migrate for alice
+  BOOST_REQUIRE_EXCEPTION(migratenonce("alice"_n, 1),
+                          eosio_assert_message_exception, eosio_assert_message_is("nothing changed"));
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(nonce_migration_from_0_5_1, call_evm_tester) try {
+  auto has_nextnonce_row = [&](name owner) {
+    return !get_row_by_account(evm_account_name, evm_account_name, "nextnonces"_n, owner).empty();
+  };
+
+  // Accounts opened by the old contract have their nonce in nextnonces
+  set_code(evm_account_name, testing::contracts::evm_runtime_wasm_0_5_1());
+  set_abi(evm_account_name, testing::contracts::evm_runtime_abi_0_5_1().data());
+
+  open("alice"_n);
+  open("bob"_n);
+  evm_eoa evm1;
+  transfer_token("alice"_n, evm_account_name, make_asset(1000000), evm1.address_0x()); // self nonce 0->1
+  produce_block();
+
+  set_code(evm_account_name, testing::contracts::evm_runtime_wasm());
+  set_abi(evm_account_name, testing::contracts::evm_runtime_abi().data());
+
+  BOOST_REQUIRE(has_nextnonce_row("alice"_n));
+  BOOST_REQUIRE(has_nextnonce_row("bob"_n));
+  BOOST_REQUIRE(has_nextnonce_row(evm_account_name));
+
+  // Compatibility read path
+  assertnonce("alice"_n, 0);
+  assertnonce(evm_account_name, 1);
+
+  // First use moves the nonce of the contract into its balances row
+  transfer_token("alice"_n, evm_account_name, make_asset(1000000), evm1.address_0x()); // self nonce 1->2
+  BOOST_REQUIRE(!has_nextnonce_row(evm_account_name));
+  assertnonce(evm_account_name, 2);
+
+  // Resumable migration of the remaining rows
+  migratenonce(""_n, 1);
+  BOOST_REQUIRE(!has_nextnonce_row("alice"_n));
+  BOOST_REQUIRE(has_nextnonce_row("bob"_n));
+  migratenonce("alice"_n, 10);
+  BOOST_REQUIRE(!has_nextnonce_row("bob"_n));
+  BOOST_REQUIRE_EXCEPTION(migratenonce(""_n, 10),
+                          eosio_assert_message_exception, eosio_assert_message_is("nothing changed"));
+
+  assertnonce("alice"_n, 0);
+  assertnonce("bob"_n, 0);
+  BOOST_REQUIRE_EXCEPTION(assertnonce("bob"_n, 1),
+                          eosio_assert_message_exception, eosio_assert_message_is("wrong nonce"));
+
+  // Migrated rows keep counting from where they were
+  transfer_token("alice"_n, evm_account_name, make_asset(1000000), "bob");
+  evmc::bytes32 v;
+  auto to = evmc::bytes();
+  auto data = evmc::from_hex(contract_bytecode);
+  call("bob"_n, to, silkworm::Bytes(v), *data, 1000000, "bob"_n); // nonce 0->1
+  assertnonce("bob"_n, 1);
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
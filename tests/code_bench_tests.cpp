@@ -0,0 +1,59 @@
+#include "bench_utils.hpp"
+
+using namespace evm_test;
+
+struct code_bench_tester : basic_evm_tester {
+
+   // Runtime code calling itself n times, n being the first word of the calldata:
+   //    n = calldataload(0); if (n == 0) stop; mstore(0, n - 1); call(gas, address, 0, 0, 32, 0, 0); stop
+   // followed by padding JUMPDESTs that make the code as large as wanted.
+   static constexpr const char* recursive_code = "600035801561001f576001900360005260006000602060006000305af150005b00";
+
+   evm_eoa evm1;
+
+   code_bench_tester() {
+      create_accounts({"alice"_n});
+      transfer_token(faucet_account_name, "alice"_n, make_asset(10000'0000));
+      init();
+      transfer_token("alice"_n, evm_account_name, make_asset(1000'0000), evm1.address_0x());
+   }
+
+   evmc::address deploy(size_t padding) {
+      silkworm::Bytes runtime = evmc::from_hex(recursive_code).value();
+      runtime.append(padding, 0x5b);
+
+      auto res = deploy_contract(evm1, make_init_code(runtime));
+      produce_block();
+      return res;
+   }
+
+   transaction_trace_ptr call(const evmc::address& to, uint64_t calls) {
+      auto txn = generate_tx(to, 0, 10'000'000);
+      uint8_t buffer[32];
+      intx::be::store(buffer, intx::uint256{calls});
+      txn.data = silkworm::Bytes{buffer, sizeof(buffer)};
+      evm1.sign(txn);
+      return pushtx(txn);
+   }
+};
+
+BOOST_AUTO_TEST_SUITE(code_bench_tests, EVM_BENCH_DECORATORS)
+
+// Repeated calls to the same code within one action only read the code row once, the rest of the cost that grows
+// with the code size is the analysis done by the interpreter for each call frame.
+BOOST_FIXTURE_TEST_CASE(repeated_calls_to_large_contracts, code_bench_tester) try {
+   bench_report report("repeated calls to the same contract");
+
+   for (size_t padding : {0, 8 * 1024, 24 * 1024 - 64}) {
+      auto contract = deploy(padding);
+      for (uint64_t calls : {1, 16, 64}) {
+         auto trace = call(contract, calls);
+         report.add(make_bench_sample("code=" + std::to_string(padding + 33) + " calls=" + std::to_string(calls), trace));
+         produce_block();
+      }
+   }
+
+   report.print();
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
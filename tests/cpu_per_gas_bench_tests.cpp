@@ -0,0 +1,204 @@
+#include <cstdlib>
+#include <random>
+
+#include "bench_utils.hpp"
+
+using namespace evm_test;
+
+struct cpu_per_gas_bench_tester : basic_evm_tester {
+
+   static constexpr uint64_t gas_limit = 1'000'000;
+
+   // Stack neutral piece of code repeated in a loop until the transaction runs out of gas
+   struct snippet {
+      std::string     name;
+      silkworm::Bytes code;
+   };
+
+   evm_eoa evm1;
+
+   cpu_per_gas_bench_tester() {
+      create_accounts({"alice"_n});
+      transfer_token(faucet_account_name, "alice"_n, make_asset(10000'0000));
+      init();
+      transfer_token("alice"_n, evm_account_name, make_asset(5000'0000), evm1.address_0x());
+      produce_block();
+   }
+
+   static silkworm::Bytes push32(uint8_t fill) {
+      silkworm::Bytes res{0x7f};
+      res.append(32, fill);
+      return res;
+   }
+
+   static silkworm::Bytes hex(const char* s) { return evmc::from_hex(s).value(); }
+
+   // op(a, b) with large operands, result popped
+   static snippet binary(const char* name, uint8_t op) {
+      return {name, push32(0xfe) + push32(0xff) + silkworm::Bytes{op, 0x50}};
+   }
+
+   static snippet ternary(const char* name, uint8_t op) {
+      return {name, push32(0xfd) + push32(0xfe) + push32(0xff) + silkworm::Bytes{op, 0x50}};
+   }
+
+   // staticcall(gas, address, 0, calldatasize, 0x1000, 0x40), the input being copied to memory before the loop
+   static snippet precompile(std::string name, uint8_t address) {
+      return {std::move(name), silkworm::Bytes{0x60, 0x40, 0x61, 0x10, 0x00, 0x36, 0x60, 0x00, 0x60, address, 0x5a, 0xfa, 0x50}};
+   }
+
+   static std::vector<snippet> opcode_snippets() {
+      return {
+         binary("ADD", 0x01),
+         binary("MUL", 0x02),
+         binary("DIV", 0x04),
+         binary("SDIV", 0x05),
+         binary("MOD", 0x06),
+         binary("SMOD", 0x07),
+         binary("EXP", 0x0a),
+         binary("SIGNEXTEND", 0x0b),
+         binary("SHL", 0x1b),
+         binary("SAR", 0x1d),
+         ternary("ADDMOD", 0x08),
+         ternary("MULMOD", 0x09),
+         {"KECCAK256 32 bytes", hex("602060002050")},
+         {"KECCAK256 4096 bytes", hex("61100060002050")},
+         {"BALANCE cold", hex("5a3150")},
+         {"EXTCODESIZE cold", hex("5a3b50")},
+         {"EXTCODEHASH cold", hex("5a3f50")},
+         {"SLOAD cold", hex("5a5450")},
+         {"SSTORE new slot", hex("5a5a55")},
+         {"BLOCKHASH", hex("43600190034050")},
+         {"MSTORE8", hex("60ff600053")},
+         {"CALLDATACOPY 1024 bytes", hex("6104006000600037")},
+      };
+   }
+
+   struct precompile_case {
+      snippet         code;
+      silkworm::Bytes input;
+   };
+
+   static std::vector<precompile_case> precompile_cases() {
+      std::vector<precompile_case> res;
+
+      auto word = [](const char* h) {
+         silkworm::Bytes w = hex(h);
+         silkworm::Bytes res(32 - w.size(), 0);
+         return res + w;
+      };
+      auto length = [](size_t v) {
+         uint8_t buffer[32];
+         intx::be::store(buffer, intx::uint256{v});
+         return silkworm::Bytes{buffer, sizeof(buffer)};
+      };
+
+      res.push_back({precompile("ecrecover", 0x01),
+         word("456e9aea5e197a1f1af7a3e85a3212fa4049a3ba34c2289b4c860fc0b0c64ef3") + word("1c") +
+         word("9242685bf161793cc25603c231bc2f568eb630ea16aa137d2664ac8038825608") +
+         word("4f8ae3bd7535248d0bd448298cc2e2071e56992d0774dc340c368ae950852ada")});
+      res.push_back({precompile("sha256 1024 bytes", 0x02), silkworm::Bytes(1024, 0xab)});
+      res.push_back({precompile("ripemd160 1024 bytes", 0x03), silkworm::Bytes(1024, 0xab)});
+      res.push_back({precompile("identity 1024 bytes", 0x04), silkworm::Bytes(1024, 0xab)});
+
+      // modexp: base length, exponent length, modulus length, then the values
+      auto modexp = [&](size_t b, size_t e, size_t m) {
+         silkworm::Bytes in = length(b) + length(e) + length(m);
+         in.append(b, 0xfe);
+         in.append(e, 0xff);
+         in.append(m, 0xfd);
+         return in;
+      };
+      res.push_back({precompile("modexp 32/32/32", 0x05), modexp(32, 32, 32)});
+      res.push_back({precompile("modexp 256/32/256", 0x05), modexp(256, 32, 256)});
+      res.push_back({precompile("modexp 8/512/8", 0x05), modexp(8, 512, 8)});
+
+      const silkworm::Bytes g1 = word("01") + word("02");
+      res.push_back({precompile("bn256add", 0x06), g1 + g1});
+      res.push_back({precompile("bn256mul", 0x07), g1 + push32(0xff).substr(1)});
+
+      // G1 and G2 generators, imaginary part first as in EIP-197
+      const silkworm::Bytes g2 =
+         word("198e9393920d483a7260bfb731fb5d25f1aa493335a9e71297e485b7aef312c2") +
+         word("1800deef121f1e76426a00665e5c4479674322d4f75edadd46debd5cd992f6ed") +
+         word("090689d0585ff075ec9e99ad690c3395bc4b313370b38ef355acdadcd122975b") +
+         word("12c85ea5db8c6deb4aab71808dcb408fe3d1e7690c43d37b4ce6cc0166fa7daa");
+      res.push_back({precompile("bn256pairing 1 pair", 0x08), g1 + g2});
+      res.push_back({precompile("bn256pairing 2 pairs", 0x08), g1 + g2 + g1 + g2});
+
+      // blake2f: rounds, h, m, t, f
+      auto blake2f = [](uint32_t rounds) {
+         silkworm::Bytes in{static_cast<uint8_t>(rounds >> 24), static_cast<uint8_t>(rounds >> 16),
+                            static_cast<uint8_t>(rounds >> 8), static_cast<uint8_t>(rounds)};
+         in.append(64 + 128 + 16, 0x5a);
+         in.push_back(1);
+         return in;
+      };
+      res.push_back({precompile("blake2f 12 rounds", 0x09), blake2f(12)});
+      res.push_back({precompile("blake2f 10000 rounds", 0x09), blake2f(10000)});
+
+      return res;
+   }
+
+   bench_sample run(const std::string& name, const silkworm::Bytes& body, const silkworm::Bytes& input = {}) {
+      auto contract = deploy_contract(evm1, make_init_code(make_gas_loop(body)));
+      produce_block();
+      auto sample = measure_call(*this, evm1, name, contract, input, gas_limit);
+      produce_block();
+      return sample;
+   }
+
+   static void print_worst(bench_report& report, size_t count) {
+      auto cpu_per_gas = [](const bench_sample& s) { return s.gas_used ? double(s.elapsed_us) / s.gas_used : 0.0; };
+      std::stable_sort(report.samples.begin(), report.samples.end(), [&](const auto& a, const auto& b) {
+         return cpu_per_gas(a) > cpu_per_gas(b);
+      });
+      if (report.samples.size() > count) report.samples.resize(count);
+      report.print();
+   }
+};
+
+// Search for the EVM code that gets the most CPU out of each unit of gas, to check the gas schedule against what
+// WASM execution really costs. Cases are sorted by ns/gas, worst first.
+BOOST_AUTO_TEST_SUITE(cpu_per_gas_bench_tests, EVM_BENCH_DECORATORS)
+
+BOOST_FIXTURE_TEST_CASE(opcodes, cpu_per_gas_bench_tester) try {
+   bench_report report("cpu per gas: opcodes");
+   for (const auto& s : opcode_snippets()) {
+      report.add(run(s.name, s.code));
+   }
+   print_worst(report, report.samples.size());
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(precompiles, cpu_per_gas_bench_tester) try {
+   bench_report report("cpu per gas: precompiles");
+   for (const auto& c : precompile_cases()) {
+      report.add(run(c.code.name, c.code.code, c.input));
+   }
+   print_worst(report, report.samples.size());
+} FC_LOG_AND_RETHROW()
+
+// Random sequences of opcode snippets, the seed can be changed through EVM_BENCH_SEED
+BOOST_FIXTURE_TEST_CASE(random_sequences, cpu_per_gas_bench_tester) try {
+   bench_report report("cpu per gas: random opcode sequences");
+
+   const char* seed_env = std::getenv("EVM_BENCH_SEED");
+   std::mt19937_64 rng(seed_env ? std::stoull(seed_env) : 1153);
+   const auto snippets = opcode_snippets();
+   std::uniform_int_distribution<size_t> pick(0, snippets.size() - 1);
+   std::uniform_int_distribution<size_t> length(2, 6);
+
+   for (size_t i = 0; i < 32; ++i) {
+      std::string name;
+      silkworm::Bytes body;
+      for (size_t n = length(rng); n > 0; --n) {
+         const auto& s = snippets[pick(rng)];
+         name += (name.empty() ? "" : ",") + s.name;
+         body += s.code;
+      }
+      report.add(run(name, body));
+   }
+   print_worst(report, 10);
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
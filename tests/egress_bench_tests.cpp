@@ -0,0 +1,109 @@
+#include "bench_utils.hpp"
+
+using namespace evm_test;
+
+struct egress_bench_tester : basic_evm_tester {
+   // Distributor.sol
+   static constexpr const char* distributor_bytecode =
+      "608060405234801561001057600080fd5b50610284806100206000396000f3fe60806040526004361061001e5760003560e01c"
+      "80632929abe614610023575b600080fd5b610036610031366004610154565b610038565b005b6000805b848110156100f45785"
+      "8582818110610056576100566101c0565b905060200201602081019061006b91906101d6565b6001600160a01b03166108fc85"
+      "8584818110610089576100896101c0565b905060200201359081150290604051600060405180830381858888f1935050505015"
+      "80156100bb573d6000803e3d6000fd5b508383828181106100ce576100ce6101c0565b90506020020135826100e0919061021c"
+      "565b9150806100ec81610235565b91505061003c565b5034811461010157600080fd5b5050505050565b60008083601f840112"
+      "61011a57600080fd5b50813567ffffffffffffffff81111561013257600080fd5b6020830191508360208260051b8501011115"
+      "61014d57600080fd5b9250929050565b6000806000806040858703121561016a57600080fd5b843567ffffffffffffffff8082"
+      "111561018257600080fd5b61018e88838901610108565b909650945060208701359150808211156101a757600080fd5b506101"
+      "b487828801610108565b95989497509550505050565b634e487b7160e01b600052603260045260246000fd5b60006020828403"
+      "12156101e857600080fd5b81356001600160a01b03811681146101ff57600080fd5b9392505050565b634e487b7160e01b6000"
+      "52601160045260246000fd5b8082018082111561022f5761022f610206565b92915050565b6000600182016102475761024761"
+      "0206565b506001019056fea26469706673582212209964e90f15129fadc3f3ade8e9fcd3b3d9c3f27617b3bcc28cf29cc5e3e5"
+      "b5dc64736f6c63430008110033";
+
+   static constexpr size_t max_payees = 64;
+
+   evm_eoa deployer;
+   evm_eoa payer;
+   evmc::address distributor;
+   std::vector<name> payees;
+
+   egress_bench_tester() {
+      create_accounts({"alice"_n});
+      transfer_token(faucet_account_name, "alice"_n, make_asset(100000'0000));
+      init();
+
+      for (size_t i = 0; i < max_payees; ++i) {
+         std::string n = "payee";
+         n += static_cast<char>('a' + i / 26);
+         n += static_cast<char>('a' + i % 26);
+         payees.emplace_back(n);
+      }
+      create_accounts(payees);
+
+      transfer_token("alice"_n, evm_account_name, make_asset(100'0000), deployer.address_0x());
+      transfer_token("alice"_n, evm_account_name, make_asset(10000'0000), payer.address_0x());
+      distributor = deploy_contract(deployer, evmc::from_hex(distributor_bytecode).value());
+      produce_block();
+   }
+
+   static silkworm::Bytes word(const intx::uint256& v) {
+      uint8_t buffer[32];
+      intx::be::store(buffer, v);
+      return silkworm::Bytes{buffer, sizeof(buffer)};
+   }
+
+   static silkworm::Bytes word(const evmc::address& a) {
+      silkworm::Bytes res(12, 0);
+      res += silkworm::Bytes{a.bytes, sizeof(a.bytes)};
+      return res;
+   }
+
+   // distribute(address[],uint256[]) sending `amount` to the reserved address of each of the first `count` payees,
+   // `repeat` times each (at most five transfers per non-open account are allowed).
+   transaction_trace_ptr distribute(size_t count, size_t repeat, const intx::uint256& amount) {
+      const size_t n = count * repeat;
+
+      silkworm::Bytes data = evmc::from_hex("2929abe6").value();
+      data += word(intx::uint256{0x40});
+      data += word(intx::uint256{0x40 + 0x20 * (n + 1)});
+      data += word(intx::uint256{n});
+      for (size_t r = 0; r < repeat; ++r) {
+         for (size_t i = 0; i < count; ++i) {
+            data += word(make_reserved_address(payees[i]));
+         }
+      }
+      data += word(intx::uint256{n});
+      for (size_t i = 0; i < n; ++i) {
+         data += word(amount);
+      }
+
+      auto txn = generate_tx(distributor, amount * n, 10'000'000);
+      txn.data = data;
+      payer.sign(txn);
+      return pushtx(txn);
+   }
+};
+
+BOOST_AUTO_TEST_SUITE(egress_bench_tests, EVM_BENCH_DECORATORS)
+
+BOOST_FIXTURE_TEST_CASE(batch_payout_to_native_accounts, egress_bench_tester) try {
+   bench_report report("egress to non-open accounts (Distributor.sol)");
+
+   const intx::uint256 one_eos = 1_ether;
+   for (size_t count : {1, 8, 16, 32, 64}) {
+      auto trace = distribute(count, 1, one_eos);
+      BOOST_REQUIRE_EQUAL(trace->action_traces.size(), 1 + 3 * count);
+      report.add(make_bench_sample("payees=" + std::to_string(count), trace));
+      produce_block();
+   }
+
+   for (size_t repeat : {2, 5}) {
+      auto trace = distribute(16, repeat, one_eos);
+      report.add(make_bench_sample("payees=16 x" + std::to_string(repeat), trace));
+      produce_block();
+   }
+
+   report.print();
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,176 @@
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+
+#include <fc/io/json.hpp>
+
+#include "bench_utils.hpp"
+
+using namespace evm_test;
+
+// Measures the billed CPU of a standard mix of EVM work and proposes the gas settings that make gas pay for it, and
+// the ingress bridge fee that makes deposits pay for theirs.
+//
+// Inputs (environment):
+//    EVM_CALIB_CPU_PRICE    price of 1 ms of CPU, in tokens (default 0.0001)
+//    EVM_CALIB_RAM_PRICE_MB price of 1 MiB of RAM, in tokens, to propose updtgasparam (optional)
+//    EVM_CALIB_MARGIN       safety factor applied to the measured CPU (default 1.5)
+//    EVM_CALIB_OUTPUT       file receiving the JSON report (default: stdout only)
+//
+// Run it once per WASM runtime, e.g.
+//    ./unit_test --run_test=gas_calibration_bench_tests -- --eos-vm-oc
+struct gas_calibration_tester : basic_evm_tester {
+
+   static constexpr uint64_t loop_gas_limit = 1'000'000;
+
+   // for (i = n; i > 0; --i) sstore(base + i, number), n and base being the first two words of the calldata
+   static constexpr const char* store_code = "6000356020355b8115601a5743818301559060019003906006565b00";
+
+   struct workload {
+      std::string     name;
+      uint32_t        weight;   // share of the mix, in transactions
+      bench_sample    sample;
+   };
+
+   evm_eoa evm1;
+
+   gas_calibration_tester() {
+      create_accounts({"alice"_n});
+      transfer_token(faucet_account_name, "alice"_n, make_asset(10000'0000));
+      init();
+      transfer_token("alice"_n, evm_account_name, make_asset(5000'0000), evm1.address_0x());
+      produce_block();
+   }
+
+   static double env(const char* name, double def) {
+      const char* v = std::getenv(name);
+      return v ? std::stod(v) : def;
+   }
+
+   static std::string wasm_runtime() {
+      const auto& suite = boost::unit_test::framework::master_test_suite();
+      for (int i = 0; i < suite.argc; ++i) {
+         const std::string arg = suite.argv[i];
+         if (arg == "--eos-vm-oc") return "eos-vm-oc";
+         if (arg == "--eos-vm-jit") return "eos-vm-jit";
+      }
+      return "eos-vm";
+   }
+
+   static silkworm::Bytes word(uint64_t v) {
+      uint8_t buffer[32];
+      intx::be::store(buffer, intx::uint256{v});
+      return silkworm::Bytes{buffer, sizeof(buffer)};
+   }
+
+   bench_sample loop(const std::string& name, const char* body_hex, const silkworm::Bytes& input = {}) {
+      auto contract = deploy_contract(evm1, make_init_code(make_gas_loop(evmc::from_hex(body_hex).value())));
+      produce_block();
+      auto sample = measure_call(*this, evm1, name, contract, input, loop_gas_limit);
+      produce_block();
+      return sample;
+   }
+
+   std::vector<workload> run_mix() {
+      std::vector<workload> res;
+
+      evm_eoa evm2;
+      res.push_back({"native value transfer", 30, measure_call(*this, evm1, "native value transfer", evm2.address, {}, 21'000)});
+      produce_block();
+
+      auto store = deploy_contract(evm1, make_init_code(evmc::from_hex(store_code).value()));
+      produce_block();
+      res.push_back({"sstore 20 new slots", 10, measure_call(*this, evm1, "sstore 20 new slots", store, word(20) + word(1000), 10'000'000)});
+      produce_blocks(2); // <- next EVM block, the slots get a new value
+      res.push_back({"sstore 20 updates", 10, measure_call(*this, evm1, "sstore 20 updates", store, word(20) + word(1000), 10'000'000)});
+      produce_block();
+
+      // ADD, MUL, DIV, MOD on small operands
+      res.push_back({"arithmetic", 20, loop("arithmetic", "600760030150600760030250600760030450600760030650")});
+      res.push_back({"keccak256 64 bytes", 10, loop("keccak256 64 bytes", "604060002050")});
+      res.push_back({"sload cold", 5, loop("sload cold", "5a5450")});
+      res.push_back({"balance cold", 5, loop("balance cold", "5a3150")});
+
+      // ecrecover: staticcall(gas, 1, 0, 128, 0x1000, 0x20)
+      silkworm::Bytes sig = word(0x1234) + word(27) + word(0x5678) + word(0x9abc);
+      res.push_back({"ecrecover", 5, loop("ecrecover", "60206110006080600060015afa50", sig)});
+      res.push_back({"sha256 256 bytes", 5, loop("sha256 256 bytes", "6020611000610100600060025afa50", silkworm::Bytes(256, 0xab))});
+
+      return res;
+   }
+};
+
+BOOST_AUTO_TEST_SUITE(gas_calibration_bench_tests, EVM_BENCH_DECORATORS)
+
+BOOST_FIXTURE_TEST_CASE(calibrate, gas_calibration_tester) try {
+   bench_report report("gas calibration mix (" + wasm_runtime() + ")");
+
+   auto mix = run_mix();
+
+   // Weighted CPU per gas over the mix, and the worst single workload
+   double cpu_us = 0, gas = 0, worst_us_per_gas = 0;
+   std::string worst;
+   fc::variants measurements;
+   for (const auto& w : mix) {
+      report.add(w.sample);
+      BOOST_REQUIRE_MESSAGE(w.sample.gas_used > 0, "workload failed: " + w.sample.name);
+      cpu_us += double(w.weight) * w.sample.cpu_usage_us;
+      gas += double(w.weight) * w.sample.gas_used;
+      const double us_per_gas = double(w.sample.cpu_usage_us) / w.sample.gas_used;
+      if (us_per_gas > worst_us_per_gas) {
+         worst_us_per_gas = us_per_gas;
+         worst = w.name;
+      }
+      measurements.emplace_back(mvo()("name", w.name)("weight", w.weight)("cpu_us", w.sample.cpu_usage_us)
+                                     ("gas", w.sample.gas_used)("us_per_mgas", us_per_gas * 1e6));
+   }
+
+   const double cpu_price = env("EVM_CALIB_CPU_PRICE", 0.0001); // <- tokens per ms
+   const double margin = env("EVM_CALIB_MARGIN", 1.5);
+   const double us_per_gas = cpu_us / gas;
+
+   // overhead_price is in wei (1e-18 token) per gas
+   const uint64_t overhead_price = static_cast<uint64_t>(us_per_gas * margin * cpu_price / 1000.0 * 1e18);
+
+   // The gas of a deposit is paid by the reserved address of the contract, the depositor only pays ingress_bridge_fee:
+   // make the fee cover the CPU of the whole deposit action
+   const auto deposit = make_bench_sample("bridge deposit",
+                                          transfer_token("alice"_n, evm_account_name, make_asset(1'0000), evm1.address_0x()));
+   report.add(deposit);
+   const auto ingress_bridge_fee = make_asset(static_cast<int64_t>(std::ceil(deposit.cpu_usage_us * margin * cpu_price / 1000.0 * 1'0000)));
+
+   // Gas a transaction can use without going over max_transaction_cpu_usage, at the worst measured rate
+   const auto max_trx_cpu = control->get_global_properties().configuration.max_transaction_cpu_usage;
+   const uint64_t max_gas_per_trx = static_cast<uint64_t>(max_trx_cpu / (worst_us_per_gas * margin));
+
+   report.print();
+
+   auto recommendations = mvo()
+      ("setgasprices", mvo()("prices", mvo()("overhead_price", overhead_price)("storage_price", fc::variant())))
+      ("setfeeparams", mvo()("fee_params", mvo()("gas_price", fc::variant())("miner_cut", fc::variant())
+                                              ("ingress_bridge_fee", ingress_bridge_fee)));
+   if (const char* ram_price = std::getenv("EVM_CALIB_RAM_PRICE_MB")) {
+      // storage gas also costs CPU, never sell it below the CPU price
+      const auto ram_price_mb = make_asset(static_cast<int64_t>(std::stod(ram_price) * 1'0000));
+      recommendations("updtgasparam", mvo()("ram_price_mb", ram_price_mb)("gas_price", overhead_price));
+   }
+
+   auto result = mvo()
+      ("wasm_runtime", wasm_runtime())
+      ("cpu_price_per_ms", cpu_price)
+      ("margin", margin)
+      ("us_per_mgas", us_per_gas * 1e6)
+      ("worst_workload", worst)
+      ("worst_us_per_mgas", worst_us_per_gas * 1e6)
+      ("max_gas_per_trx", max_gas_per_trx)
+      ("measurements", measurements)
+      ("actions", recommendations);
+
+   const auto json = fc::json::to_pretty_string(fc::variant(result));
+   std::cout << json << std::endl;
+   if (const char* output = std::getenv("EVM_CALIB_OUTPUT")) {
+      std::ofstream(output) << json << std::endl;
+   }
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
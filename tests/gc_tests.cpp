@@ -0,0 +1,255 @@
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+
+#include "simple_contract_tester.hpp"
+#include "utils.hpp"
+
+using namespace evm_test;
+using eosio::testing::eosio_assert_message_is;
+
+struct gc_tester : simple_contract_tester {
+
+   // Runtime code: CALLER SELFDESTRUCT, i.e. a contract without storage that destroys itself when called
+   static constexpr const char* suicide_bytecode = "6002600c60003960026000f333ff";
+
+   gc_tester() {
+      open("alice"_n);
+   }
+
+   // Deploy Simple, set its value and selfdestruct it: leaves one gcstore row and two storage rows behind
+   void churn() {
+      auto contract_addr = deploy_contract(evm1, evmc::from_hex(simple_bytecode).value());
+      call(contract_addr, setval(1));
+      call(contract_addr, "24d97a4a"); // killme()
+      produce_block();
+   }
+
+   uint64_t storage_slots(const evmc::address& addr) {
+      auto account = find_account_by_address(addr);
+      BOOST_REQUIRE(account.has_value() && account->storage_slots.has_value());
+      return *account->storage_slots;
+   }
+
+   // Rows waiting to be garbage collected (gcstore rows plus the storage rows they point to)
+   size_t gc_debt() {
+      size_t total = 0;
+      scan_gcstore([&](gcstore row) -> bool {
+         ++total;
+         scan_account_storage(row.storage_id, [&](storage_slot) -> bool {
+            ++total;
+            return false;
+         });
+         return false;
+      });
+      return total;
+   }
+};
+
+BOOST_AUTO_TEST_SUITE(gc_tests)
+
+BOOST_FIXTURE_TEST_CASE(setgcbudget_tests, gc_tester) try {
+
+   BOOST_REQUIRE(get_config().gc_budget.value_or(0) == 0);
+
+   BOOST_REQUIRE_EXCEPTION(setgcbudget(10, "alice"_n),
+      missing_auth_exception, eosio::testing::fc_exception_message_starts_with("missing authority"));
+
+   setgcbudget(10);
+   BOOST_REQUIRE(get_config().gc_budget.value() == 10);
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(gc_debt_grows_without_budget, gc_tester) try {
+
+   for (size_t i = 1; i <= 3; ++i) {
+      churn();
+      BOOST_REQUIRE_EQUAL(gc_debt(), 3 * i);
+   }
+
+   // Explicit gc still works
+   gc(100);
+   BOOST_REQUIRE_EQUAL(gc_debt(), 0);
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(gc_debt_bounded_under_churn, gc_tester) try {
+
+   // A budget covering the garbage of one selfdestruct collects it in the same transaction
+   setgcbudget(3);
+   for (size_t i = 0; i < 10; ++i) {
+      churn();
+      BOOST_REQUIRE_EQUAL(gc_debt(), 0);
+   }
+
+   // A smaller budget spreads the work over the following transactions, debt never exceeds one churn cycle
+   setgcbudget(1);
+   for (size_t i = 0; i < 10; ++i) {
+      churn();
+      BOOST_REQUIRE_LE(gc_debt(), 3);
+   }
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(gc_on_transfer_and_withdraw, gc_tester) try {
+
+   churn();
+   churn();
+   BOOST_REQUIRE_EQUAL(gc_debt(), 6);
+
+   setgcbudget(4);
+
+   // Deposit to an opened account
+   transfer_token("alice"_n, evm_account_name, make_asset(1'0000), "alice");
+   BOOST_REQUIRE_EQUAL(gc_debt(), 2);
+
+   withdraw("alice"_n, make_asset(1'0000));
+   BOOST_REQUIRE_EQUAL(gc_debt(), 0);
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(storage_slots_tracking, gc_tester) try {
+
+   // owner is stored by the constructor
+   auto c1 = deploy_contract(evm1, evmc::from_hex(simple_bytecode).value());
+   BOOST_REQUIRE_EQUAL(storage_slots(c1), 1);
+
+   call(c1, setval(7));
+   BOOST_REQUIRE_EQUAL(storage_slots(c1), 2);
+
+   // Updating a slot does not change the count, clearing it does
+   call(c1, setval(8));
+   BOOST_REQUIRE_EQUAL(storage_slots(c1), 2);
+   call(c1, setval(0));
+   BOOST_REQUIRE_EQUAL(storage_slots(c1), 1);
+
+   // EOAs are tracked too
+   BOOST_REQUIRE_EQUAL(storage_slots(evm1.address), 0);
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(storage_restored_within_transaction, gc_tester) try {
+
+   // Reentrancy guard: sstore(0, 2); sstore(0, calldataload(0)), slot 0 set to 1 by the constructor
+   static constexpr const char* guard_bytecode = "600160005561000c61001460003961000c6000f3600260005560003560005500";
+   auto guard = deploy_contract(evm1, evmc::from_hex(guard_bytecode).value());
+   const auto guard_id = find_account_by_address(guard).value().id;
+   produce_block();
+
+   auto slot0 = [&]() {
+      std::optional<storage_slot> res;
+      scan_account_storage(guard_id, [&](storage_slot s) -> bool {
+         if (s.key == 0) res = s;
+         return false;
+      });
+      BOOST_REQUIRE(res.has_value());
+      return *res;
+   };
+
+   // Storage updates printed by contracts built with WITH_DB_STATS (6th number), nullopt otherwise
+   auto storage_updates = [](const transaction_trace_ptr& trace) -> std::optional<uint32_t> {
+      static const std::string prefix = "db_stats: ";
+      for (const auto& at : trace->action_traces) {
+         auto pos = at.console.rfind(prefix);
+         if (at.act.name != "pushtx"_n || pos == std::string::npos) continue;
+         std::istringstream in(at.console.substr(pos + prefix.size()));
+         uint32_t v[6];
+         for (auto& x : v) in >> x;
+         if (in) return v[5];
+      }
+      return {};
+   };
+
+   auto run = [&](uint64_t v) {
+      auto txn = generate_tx(guard, 0, 100'000);
+      txn.data = evmc::from_hex(setval(v).substr(8)).value();
+      evm1.sign(txn);
+      return pushtx(txn);
+   };
+
+   // Warm up: the first transaction of an EVM block may create rows of its own
+   run(1);
+   const auto before = slot0();
+   const auto ram = control->get_resource_limits_manager().get_account_ram_usage(evm_account_name);
+
+   // 1 -> 2 -> 1: the row is left as is
+   auto trace = run(1);
+   const auto after = slot0();
+   BOOST_REQUIRE_EQUAL(after.id, before.id);
+   BOOST_REQUIRE(after.value == 1);
+   BOOST_REQUIRE_EQUAL(control->get_resource_limits_manager().get_account_ram_usage(evm_account_name), ram);
+   BOOST_REQUIRE_EQUAL(storage_slots(guard), 1);
+   if (auto updates = storage_updates(trace)) BOOST_REQUIRE_EQUAL(*updates, 0);
+
+   // 1 -> 2 -> 3: one row update
+   trace = run(3);
+   BOOST_REQUIRE(slot0().value == 3);
+   if (auto updates = storage_updates(trace)) BOOST_REQUIRE_EQUAL(*updates, 1);
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(no_gc_for_empty_storage, gc_tester) try {
+
+   auto c1 = deploy_contract(evm1, evmc::from_hex(suicide_bytecode).value());
+   BOOST_REQUIRE_EQUAL(storage_slots(c1), 0);
+
+   call(c1, "");
+   BOOST_REQUIRE(!find_account_by_address(c1).has_value());
+   BOOST_REQUIRE_EQUAL(gc_debt(), 0);
+
+   // Accounts with storage still go through gc
+   churn();
+   BOOST_REQUIRE_EQUAL(gc_debt(), 3);
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(topstorage_tests, gc_tester) try {
+
+   auto page = topstorage(0, 100, 10);
+   BOOST_REQUIRE(page.accounts.empty());
+   BOOST_REQUIRE(!page.next.has_value());
+
+   BOOST_REQUIRE_EXCEPTION(topstorage(0, 0, 10),
+      eosio_assert_message_exception, eosio_assert_message_is("scan must be greater than zero"));
+
+   auto c1 = deploy_contract(evm1, evmc::from_hex(simple_bytecode).value());
+   auto c2 = deploy_contract(evm1, evmc::from_hex(simple_bytecode).value());
+   call(c2, setval(1));
+   produce_block(); // <- the same query again would be a duplicate transaction
+
+   page = topstorage(0, 100, 10);
+   BOOST_REQUIRE(!page.next.has_value());
+   const auto& top = page.accounts;
+   BOOST_REQUIRE_EQUAL(top.size(), 2);
+   BOOST_REQUIRE(top[0].eth_address == to_bytes(c2));
+   BOOST_REQUIRE_EQUAL(top[0].storage_slots, 2);
+   BOOST_REQUIRE(top[1].eth_address == to_bytes(c1));
+   BOOST_REQUIRE_EQUAL(top[1].storage_slots, 1);
+
+   auto first = topstorage(0, 100, 1);
+   BOOST_REQUIRE_EQUAL(first.accounts.size(), 1);
+   BOOST_REQUIRE(first.accounts[0].eth_address == to_bytes(c2));
+
+   BOOST_REQUIRE(topstorage(0, 100, 0).accounts.empty());
+
+   // One account per page, the pages merged by the caller give the same result
+   std::vector<account_storage> merged;
+   std::optional<uint64_t> cursor = 0;
+   size_t pages = 0;
+   while (cursor) {
+      auto p = topstorage(*cursor, 1, 10);
+      BOOST_REQUIRE_LE(p.accounts.size(), 1);
+      merged.insert(merged.end(), p.accounts.begin(), p.accounts.end());
+      BOOST_REQUIRE(!p.next || *p.next > *cursor);
+      cursor = p.next;
+      ++pages;
+   }
+   BOOST_REQUIRE_GE(pages, 3); // <- evm1, c1 and c2 at least
+   std::sort(merged.begin(), merged.end(), [](const auto& a, const auto& b) { return a.storage_slots > b.storage_slots; });
+   BOOST_REQUIRE_EQUAL(merged.size(), 2);
+   BOOST_REQUIRE(merged[0].eth_address == top[0].eth_address);
+   BOOST_REQUIRE(merged[1].eth_address == top[1].eth_address);
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
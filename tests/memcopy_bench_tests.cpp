@@ -0,0 +1,53 @@
+#include "bench_utils.hpp"
+
+using namespace evm_test;
+
+struct memcopy_bench_tester : basic_evm_tester {
+
+   // Copy n bytes (first word of the calldata) from memory offset 0 to offset n, the way compilers without MCOPY
+   // do it: for (i = 0; i < n; i += 32) mstore(n + i, mload(i))
+   static constexpr const char* word_loop_code = "60003560005b818110156019578051828201526020016005565b00";
+
+   // Same copy through the identity precompile: staticcall(gas, 4, 0, n, n, n)
+   static constexpr const char* identity_code = "6000358080600060045afa5000";
+
+   evm_eoa evm1;
+   evmc::address word_loop;
+   evmc::address identity;
+
+   memcopy_bench_tester() {
+      create_accounts({"alice"_n});
+      transfer_token(faucet_account_name, "alice"_n, make_asset(10000'0000));
+      init();
+      transfer_token("alice"_n, evm_account_name, make_asset(1000'0000), evm1.address_0x());
+      word_loop = deploy_contract(evm1, make_init_code(evmc::from_hex(word_loop_code).value()));
+      identity = deploy_contract(evm1, make_init_code(evmc::from_hex(identity_code).value()));
+      produce_block();
+   }
+
+   transaction_trace_ptr copy(const evmc::address& to, uint64_t size) {
+      auto txn = generate_tx(to, 0, 10'000'000);
+      uint8_t buffer[32];
+      intx::be::store(buffer, intx::uint256{size});
+      txn.data = silkworm::Bytes{buffer, sizeof(buffer)};
+      evm1.sign(txn);
+      return pushtx(txn);
+   }
+};
+
+BOOST_AUTO_TEST_SUITE(memcopy_bench_tests, EVM_BENCH_DECORATORS)
+
+// Baseline for the memory copies done by ABI encoders and decoders until MCOPY (EIP-5656) is available
+BOOST_FIXTURE_TEST_CASE(memory_copy, memcopy_bench_tester) try {
+   bench_report report("memory copy: mload/mstore loop vs identity precompile");
+
+   for (uint64_t size : {256, 4 * 1024, 32 * 1024}) {
+      report.add(make_bench_sample("word loop bytes=" + std::to_string(size), copy(word_loop, size)));
+      report.add(make_bench_sample("identity bytes=" + std::to_string(size), copy(identity, size)));
+      produce_block();
+   }
+
+   report.print();
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,81 @@
+#include "bench_utils.hpp"
+
+using namespace evm_test;
+
+// Linear memory, stack high-water mark and heap allocations of representative actions. The contract must be built
+// with WITH_MEMORY_STATS, every other benchmark report then shows the same columns:
+//    cmake .. -DWITH_TEST_ACTIONS=1 -DWITH_LARGE_STACK=1 -DWITH_MEMORY_STATS=1
+//    ./unit_test --run_test=memory_bench_tests -- --eos-vm-oc
+// The stack of the nested calls is to be compared with the --stack-size of the contract (35984 bytes).
+struct memory_bench_tester : basic_evm_tester {
+
+   // Calls itself calldataload(0) times: if (level) { mstore(0, level - 1); call(gas, address, 0, 0, 32, 0, 0) }
+   static constexpr const char* nested_call_code = "60003580600857005b6001900360005260006000602060006000305af100";
+   // mload(0x80000): grows the EVM memory to 512 KiB
+   static constexpr const char* memory_expansion_code = "620800005100";
+
+   evm_eoa       evm1;
+   evmc::address token;
+   evmc::address nested;
+   evmc::address expansion;
+
+   memory_bench_tester() {
+      create_accounts({"alice"_n});
+      transfer_token(faucet_account_name, "alice"_n, make_asset(10000'0000));
+      init();
+      transfer_token("alice"_n, evm_account_name, make_asset(5000'0000), evm1.address_0x());
+
+      token = deploy_contract(evm1, make_init_code(evmc::from_hex(token_runtime).value(), evmc::from_hex(token_mint).value()));
+      nested = deploy_contract(evm1, make_init_code(evmc::from_hex(nested_call_code).value()));
+      expansion = deploy_contract(evm1, make_init_code(evmc::from_hex(memory_expansion_code).value()));
+      produce_block();
+   }
+};
+
+BOOST_AUTO_TEST_SUITE(memory_bench_tests, EVM_BENCH_DECORATORS)
+
+BOOST_FIXTURE_TEST_CASE(action_memory, memory_bench_tester) try {
+   bench_report report("memory per action");
+
+   report.add(make_bench_sample("ingress transfer", transfer_token("alice"_n, evm_account_name, make_asset(1'0000), evm1.address_0x())));
+
+   evm_eoa evm2;
+   auto txn = generate_tx(evm2.address, 1);
+   evm1.sign(txn);
+   report.add(make_bench_sample("pushtx transfer to new account", pushtx(txn), 21'000));
+
+   txn = generate_tx(evm2.address, 1);
+   evm1.sign(txn);
+   report.add(make_bench_sample("pushtx transfer to existing account", pushtx(txn), 21'000));
+
+   report.add(measure_call(*this, evm1, "pushtx erc20 transfer", token, token_transfer_data(evm2.address, 1), 100'000));
+
+   auto deploy = generate_tx(evmc::address{}, 0, 2'000'000);
+   deploy.to.reset();
+   deploy.data = make_init_code(evmc::from_hex(token_runtime).value(), evmc::from_hex(token_mint).value());
+   evm1.sign(deploy);
+   report.add(make_bench_sample("pushtx erc20 deployment", pushtx(deploy)));
+
+   report.add(measure_call(*this, evm1, "pushtx evm memory to 512 KiB", expansion, {}, 1'000'000));
+
+   for (uint64_t level : {0, 1, 2, 5, 10, 20}) {
+      silkworm::Bytes data;
+      data += evmc::bytes32{level};
+      report.add(measure_call(*this, evm1, "pushtx nested calls, depth " + std::to_string(level), nested, data, 1'000'000));
+   }
+
+   exec_input input;
+   input.from = to_bytes(evm1.address);
+   input.to = to_bytes(token);
+   const auto data = token_transfer_data(evm2.address, 1);
+   input.data = bytes(data.begin(), data.end());
+   report.add(make_bench_sample("exec erc20 transfer", exec(input, {})));
+
+   report.print();
+
+   if (std::none_of(report.samples.begin(), report.samples.end(), [](const auto& s) { return s.memory.has_value(); })) {
+      BOOST_TEST_MESSAGE("no mem_stats in the action console, build the contract with WITH_MEMORY_STATS");
+   }
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1108,4 +1108,95 @@ BOOST_FIXTURE_TEST_CASE(evm_eos_fanout_memo, native_token_evm_tester_EOS) try {
 
 } FC_LOG_AND_RETHROW()
 
+BOOST_FIXTURE_TEST_CASE(withdrawmany_tests, native_token_evm_tester_EOS) try {
+   create_accounts({"exchange"_n});
+   open("exchange"_n);
+   transfer_token(faucet_account_name, evm_account_name, make_asset(10'0000), "exchange");
+
+   const int64_t alice_before = native_balance("alice"_n);
+   const int64_t bob_before = native_balance("bob"_n);
+   const int64_t carol_before = native_balance("carol"_n);
+
+   BOOST_REQUIRE_EXCEPTION(withdrawmany("exchange"_n, {}),
+                           eosio_assert_message_exception, eosio_assert_message_is("no payouts"));
+
+   BOOST_REQUIRE_EXCEPTION(withdrawmany("exchange"_n, {{"alice"_n, make_asset(1'0000)}, {"bob"_n, make_asset(0)}}),
+                           eosio_assert_message_exception, eosio_assert_message_is("must withdraw positive quantity"));
+
+   BOOST_REQUIRE_EXCEPTION(withdrawmany("exchange"_n, {{"alice"_n, make_asset(1'0000)}, {"bob"_n, asset(1'0000, symbol::from_string("4,OTHER"))}}),
+                           eosio_assert_message_exception, eosio_assert_message_is("invalid symbol"));
+
+   // The sum of all payouts must be covered
+   BOOST_REQUIRE_EXCEPTION(withdrawmany("exchange"_n, {{"alice"_n, make_asset(6'0000)}, {"bob"_n, make_asset(4'0001)}}),
+                           eosio_assert_message_exception, eosio_assert_message_is("overdrawn balance"));
+
+   BOOST_REQUIRE_EXCEPTION(withdrawmany("alice"_n, {{"bob"_n, make_asset(1)}}),
+                           eosio_assert_message_exception, eosio_assert_message_is("account is not open"));
+
+   auto trace = withdrawmany("exchange"_n, {{"alice"_n, make_asset(1'0000)}, {"bob"_n, make_asset(2'0000)}, {"carol"_n, make_asset(3'0000)}, {"alice"_n, make_asset(5)}});
+
+   // one withdrawmany plus one transfer (and its notifications) per payout
+   size_t transfers = 0;
+   for (const auto& at : trace->action_traces) {
+      if (at.act.name == "transfer"_n && at.receiver == at.act.account) ++transfers;
+   }
+   BOOST_REQUIRE_EQUAL(transfers, 4);
+
+   BOOST_REQUIRE_EQUAL(native_balance("alice"_n) - alice_before, 1'0005);
+   BOOST_REQUIRE_EQUAL(native_balance("bob"_n) - bob_before, 2'0000);
+   BOOST_REQUIRE_EQUAL(native_balance("carol"_n) - carol_before, 3'0000);
+   BOOST_REQUIRE_EQUAL(vault_balance_token("exchange"_n), 3'9995);
+}
+FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(bridgemany_tests, native_token_evm_tester_EOS) try {
+   create_accounts({"exchange"_n});
+   open("exchange"_n);
+   transfer_token(faucet_account_name, evm_account_name, make_asset(20'0000), "exchange");
+
+   evm_eoa evm1, evm2, evm3;
+   const intx::uint256 smallest = 100_szabo;
+
+   const int64_t bridge_fee = 1000;
+   setfeeparams(fee_parameters{.ingress_bridge_fee = make_asset(bridge_fee)});
+
+   BOOST_REQUIRE_EXCEPTION(bridgemany("exchange"_n, {}),
+                           eosio_assert_message_exception, eosio_assert_message_is("no credits"));
+
+   BOOST_REQUIRE_EXCEPTION(bridgemany("exchange"_n, {{evm1.address, make_asset(1'0000)}, {evm2.address, make_asset(bridge_fee)}}),
+                           eosio_assert_message_exception, eosio_assert_message_is("must bridge more than ingress bridge fee"));
+
+   BOOST_REQUIRE_EXCEPTION(bridgemany("exchange"_n, {{evm1.address, make_asset(1'0000)}, {evm2.address, asset(1'0000, symbol::from_string("4,OTHER"))}}),
+                           eosio_assert_message_exception, eosio_assert_message_is("invalid symbol"));
+
+   BOOST_REQUIRE_EXCEPTION(bridgemany("exchange"_n, {{evm1.address, make_asset(10'0000)}, {evm2.address, make_asset(10'0001)}}),
+                           eosio_assert_message_exception, eosio_assert_message_is("overdrawn balance"));
+
+   BOOST_REQUIRE_EXCEPTION(bridgemany("alice"_n, {{evm1.address, make_asset(1'0000)}}),
+                           eosio_assert_message_exception, eosio_assert_message_is("account is not open"));
+
+   intx::uint256 special_before{vault_balance("evm"_n)};
+   auto expected_inevm = inevm();
+
+   auto trace = bridgemany("exchange"_n, {{evm1.address, make_asset(1'0000)}, {evm2.address, make_asset(2'0000)}, {evm3.address, make_asset(3'0000)}, {evm1.address, make_asset(5'0000)}});
+
+   // one bridge transaction per credit
+   size_t bridge_txs = 0;
+   for (const auto& at : trace->action_traces) {
+      if (at.act.name == "pushtx"_n) ++bridge_txs;
+   }
+   BOOST_REQUIRE_EQUAL(bridge_txs, 4);
+
+   BOOST_REQUIRE(evm_balance(evm1) == smallest * (1'0000 - bridge_fee + 5'0000 - bridge_fee));
+   BOOST_REQUIRE(evm_balance(evm2) == smallest * (2'0000 - bridge_fee));
+   BOOST_REQUIRE(evm_balance(evm3) == smallest * (3'0000 - bridge_fee));
+   BOOST_REQUIRE_EQUAL(vault_balance_token("exchange"_n), 9'0000);
+
+   // the fee is charged per credit
+   BOOST_REQUIRE_EQUAL(static_cast<intx::uint256>(vault_balance("evm"_n)), special_before + smallest * (4 * bridge_fee));
+   expected_inevm.balance += make_asset(11'0000 - 4 * bridge_fee);
+   BOOST_REQUIRE(expected_inevm == inevm());
+}
+FC_LOG_AND_RETHROW()
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,358 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <set>
+#include <sstream>
+
+#include <fc/io/json.hpp>
+
+#include "basic_evm_tester.hpp"
+#include "state_export.hpp"
+
+// Offline replay of recorded EVM traffic, to compare contract builds on real transaction mixes.
+//
+// A recording is a JSON file made only of local data:
+//
+//    {
+//       "chain_id": 17777,
+//       "evm_version": 3,
+//       "gas_price": 150000000000,        <- versions 0 to 2
+//       "overhead_price": 150000000000,   <- version 3 on, both optional
+//       "storage_price": 150000000000,
+//       "snapshot": "prestate.bin",       <- optional, written by state_snapshot::write, relative to the recording
+//       "transactions": [
+//          {"pushtx": "<hex>", "block": 10},
+//          {"evmtx": "<hex>", "block": 11}
+//       ]
+//    }
+//
+// pushtx entries hold the data of recorded pushtx actions, evmtx entries the data of evmtx events, both only provide
+// the signed EVM transaction. "block" is optional, a new Antelope block is produced each time it changes. Every
+// transaction is replayed through pushtx with the EVM contract as miner.
+
+namespace evm_test {
+
+struct replay_recording {
+   uint64_t                chain_id    = basic_evm_tester::evm_chain_id;
+   uint64_t                evm_version = 0;
+   uint64_t                gas_price   = basic_evm_tester::suggested_gas_price;
+   std::optional<uint64_t> overhead_price;
+   std::optional<uint64_t> storage_price;
+   std::string             snapshot; // <- absolute path, empty for an empty pre-state
+
+   struct entry {
+      bytes                   rlptx;
+      std::optional<uint64_t> block;
+   };
+   std::vector<entry> transactions;
+
+   static bytes rlptx_from_pushtx(const bytes& data) {
+      fc::datastream<const char*> ds(data.data(), data.size());
+      name  miner;
+      bytes rlptx;
+      fc::raw::unpack(ds, miner);
+      fc::raw::unpack(ds, rlptx);
+      return rlptx;
+   }
+
+   static bytes rlptx_from_evmtx(const bytes& data) {
+      auto event = fc::raw::unpack<evmtx_type>(data.data(), data.size());
+      return std::visit([](const auto& v) { return v.rlptx; }, event);
+   }
+
+   static replay_recording read(const std::string& path) {
+      const auto file = fc::json::from_file(path);
+      const auto& v = file.get_object();
+
+      replay_recording res;
+      if (v.contains("chain_id")) res.chain_id = v["chain_id"].as_uint64();
+      if (v.contains("evm_version")) res.evm_version = v["evm_version"].as_uint64();
+      if (v.contains("gas_price")) res.gas_price = v["gas_price"].as_uint64();
+      if (v.contains("overhead_price")) res.overhead_price = v["overhead_price"].as_uint64();
+      if (v.contains("storage_price")) res.storage_price = v["storage_price"].as_uint64();
+      if (v.contains("snapshot")) {
+         res.snapshot = (std::filesystem::path(path).parent_path() / v["snapshot"].as_string()).string();
+      }
+
+      for (const auto& t : v["transactions"].get_array()) {
+         const auto& o = t.get_object();
+         entry e;
+         if (o.contains("pushtx")) {
+            e.rlptx = rlptx_from_pushtx(o["pushtx"].as<bytes>());
+         } else {
+            BOOST_REQUIRE_MESSAGE(o.contains("evmtx"), "transaction entry without pushtx or evmtx");
+            e.rlptx = rlptx_from_evmtx(o["evmtx"].as<bytes>());
+         }
+         if (o.contains("block")) e.block = o["block"].as_uint64();
+         res.transactions.push_back(std::move(e));
+      }
+      return res;
+   }
+
+   // Transactions are written back as pushtx entries
+   void write(const std::string& path) const {
+      fc::variants txs;
+      for (const auto& e : transactions) {
+         bytes data = fc::raw::pack(basic_evm_tester::evm_account_name);
+         const auto rlp = fc::raw::pack(e.rlptx);
+         data.insert(data.end(), rlp.begin(), rlp.end());
+         mvo t;
+         t("pushtx", data);
+         if (e.block) t("block", *e.block);
+         txs.emplace_back(std::move(t));
+      }
+
+      mvo v;
+      v("chain_id", chain_id)("evm_version", evm_version)("gas_price", gas_price);
+      if (overhead_price) v("overhead_price", *overhead_price);
+      if (storage_price) v("storage_price", *storage_price);
+      if (!snapshot.empty()) v("snapshot", std::filesystem::relative(snapshot, std::filesystem::path(path).parent_path()).string());
+      v("transactions", std::move(txs));
+      fc::json::save_to_file(fc::variant(std::move(v)), path, true);
+   }
+};
+
+// Table operations of one EVM transaction, only printed by contracts built with WITH_DB_STATS:
+// account read/update/create/remove then storage read/update/create/remove
+using replay_db_ops = std::array<uint32_t, 8>;
+
+inline std::optional<replay_db_ops> parse_db_stats(const std::string& console) {
+   static const std::string prefix = "db_stats: ";
+   auto pos = console.rfind(prefix);
+   if (pos == std::string::npos) return {};
+
+   std::istringstream in(console.substr(pos + prefix.size()));
+   replay_db_ops res;
+   for (auto& v : res) {
+      if (!(in >> v)) return {};
+   }
+   return res;
+}
+
+struct replay_sample {
+   std::string                  error;             // <- empty when the transaction was applied
+   uint64_t                     cpu_usage_us = 0;
+   int64_t                      elapsed_us   = 0;
+   int64_t                      ram_delta    = 0;  // <- bytes, summed over all accounts
+   std::optional<replay_db_ops> db_ops;
+
+   uint32_t db_reads() const { return db_ops ? (*db_ops)[0] + (*db_ops)[4] : 0; }
+   uint32_t db_writes() const {
+      if (!db_ops) return 0;
+      const auto& d = *db_ops;
+      return d[1] + d[2] + d[3] + d[5] + d[6] + d[7];
+   }
+};
+
+// The pre-state is always loaded by the contract of this tree through importstate, the build under test (if any) is
+// set right before the transactions are replayed, so it must use the same table layout.
+class replay_tester : public basic_evm_tester {
+public:
+   static constexpr uint32_t import_rows = 500; // <- accounts, slots and codes per importstate batch
+   static constexpr size_t   import_code_bytes = 256 * 1024;
+
+   explicit replay_tester(const replay_recording& recording, const std::string& wasm_path = {})
+      : _recording(recording) {
+      init(recording.chain_id, recording.gas_price);
+      if (recording.evm_version >= 3) {
+         setgasprices({.overhead_price = recording.overhead_price,
+                       .storage_price = recording.storage_price.value_or(recording.gas_price)});
+      }
+      if (recording.evm_version > 0) {
+         setversion(recording.evm_version, evm_account_name);
+         produce_block();
+         produce_block();
+      }
+
+      if (!recording.snapshot.empty()) {
+         load_snapshot(state_snapshot::read(recording.snapshot));
+      }
+
+      if (!wasm_path.empty()) {
+         auto abi_path = std::filesystem::path(wasm_path).replace_extension(".abi").string();
+         set_code(evm_account_name, testing::read_wasm(wasm_path.c_str()));
+         set_abi(evm_account_name, testing::read_abi(abi_path.c_str()).data());
+      }
+      produce_block();
+   }
+
+   void load_snapshot(const state_snapshot& snapshot) {
+      std::map<bytes, const snapshot_code*> codes;
+      for (const auto& c : snapshot.codes) {
+         codes[bytes(std::begin(c.code_hash), std::end(c.code_hash))] = &c;
+      }
+
+      state_batch batch;
+      uint32_t    rows = 0;
+      size_t      code_bytes = 0;
+      auto flush = [&]() {
+         if (batch.accounts.empty()) return;
+         importstate(batch);
+         produce_block();
+         batch = {};
+         rows = 0;
+         code_bytes = 0;
+      };
+
+      std::set<bytes> imported_codes;
+      for (const auto& a : snapshot.accounts) {
+         imported_account row{
+            .address   = bytes(std::begin(a.address), std::end(a.address)),
+            .nonce     = a.nonce,
+            .balance   = bytes(std::begin(a.balance), std::end(a.balance)),
+            .code_hash = {},
+            .storage   = {},
+         };
+         if (a.has_code) {
+            row.code_hash = bytes(std::begin(a.code_hash), std::end(a.code_hash));
+            if (imported_codes.insert(*row.code_hash).second) {
+               const auto* code = codes.at(*row.code_hash);
+               if (code_bytes + code->size > import_code_bytes) flush();
+               const auto* blob = snapshot.code_blobs.data() + code->offset;
+               batch.codes.emplace_back(blob, blob + code->size);
+               code_bytes += code->size;
+               ++rows;
+            }
+         }
+
+         // Accounts with more slots than a batch holds are imported in several parts
+         for (uint64_t i = 0; i < a.slot_count; ++i) {
+            if (rows + 1 >= import_rows) {
+               batch.accounts.push_back(row);
+               flush();
+               row.storage.clear();
+            }
+            const auto& s = snapshot.slots[a.first_slot + i];
+            row.storage.push_back({bytes(std::begin(s.key), std::end(s.key)), bytes(std::begin(s.value), std::end(s.value))});
+            ++rows;
+         }
+         batch.accounts.push_back(std::move(row));
+         if (++rows >= import_rows) flush();
+      }
+      flush();
+   }
+
+   std::vector<replay_sample> replay() {
+      std::vector<replay_sample> res;
+      std::optional<uint64_t> block;
+      for (const auto& e : _recording.transactions) {
+         if (e.block && block && *e.block != *block) produce_block();
+         if (e.block) block = e.block;
+
+         bytes data = fc::raw::pack(evm_account_name);
+         const auto rlp = fc::raw::pack(e.rlptx);
+         data.insert(data.end(), rlp.begin(), rlp.end());
+
+         replay_sample sample;
+         try {
+            auto trace = push_action(evm_account_name, "pushtx"_n, evm_account_name, data);
+            sample.cpu_usage_us = trace->receipt->cpu_usage_us;
+            sample.elapsed_us = trace->elapsed.count();
+            for (const auto& at : trace->action_traces) {
+               for (const auto& d : at.account_ram_deltas) sample.ram_delta += d.delta;
+               if (at.receiver == evm_account_name && at.act.name == "pushtx"_n) sample.db_ops = parse_db_stats(at.console);
+            }
+         } catch (const fc::exception& ex) {
+            sample.error = ex.top_message();
+         }
+         res.push_back(std::move(sample));
+      }
+      return res;
+   }
+
+private:
+   replay_recording _recording;
+};
+
+inline uint64_t replay_percentile(std::vector<uint64_t> v, double p) {
+   if (v.empty()) return 0;
+   std::sort(v.begin(), v.end());
+   return v[std::min(v.size() - 1, static_cast<size_t>(p * v.size()))];
+}
+
+inline void print_replay(const std::string& title, const std::vector<replay_sample>& samples,
+                         std::ostream& os = std::cout) {
+   os << "\n== " << title << " ==\n";
+   os << std::right << std::setw(8) << "tx"
+      << std::setw(10) << "cpu_us"
+      << std::setw(12) << "elapsed_us"
+      << std::setw(10) << "ram"
+      << std::setw(10) << "db_reads"
+      << std::setw(10) << "db_writes" << "  error\n";
+
+   std::vector<uint64_t> cpu;
+   uint64_t failed = 0;
+   int64_t  ram = 0;
+   for (size_t i = 0; i < samples.size(); ++i) {
+      const auto& s = samples[i];
+      os << std::setw(8) << i << std::setw(10) << s.cpu_usage_us << std::setw(12) << s.elapsed_us
+         << std::setw(10) << s.ram_delta;
+      if (s.db_ops) {
+         os << std::setw(10) << s.db_reads() << std::setw(10) << s.db_writes();
+      } else {
+         os << std::setw(10) << "-" << std::setw(10) << "-";
+      }
+      os << "  " << s.error << "\n";
+      if (s.error.empty()) {
+         cpu.push_back(s.cpu_usage_us);
+      } else {
+         ++failed;
+      }
+      ram += s.ram_delta;
+   }
+
+   os << "applied " << cpu.size() << ", failed " << failed
+      << ", cpu_us total " << std::accumulate(cpu.begin(), cpu.end(), uint64_t{0})
+      << " p50 " << replay_percentile(cpu, 0.5) << " p99 " << replay_percentile(cpu, 0.99)
+      << ", ram " << ram << "\n";
+   os.flush();
+}
+
+// Per transaction change from a baseline run to the current one, for transactions applied by both
+inline void print_replay_diff(const std::vector<replay_sample>& base, const std::vector<replay_sample>& current,
+                              std::ostream& os = std::cout) {
+   BOOST_REQUIRE_EQUAL(base.size(), current.size());
+   os << "\n== replay diff (current - baseline) ==\n";
+   os << std::right << std::setw(8) << "tx"
+      << std::setw(10) << "cpu_us"
+      << std::setw(10) << "cpu_%"
+      << std::setw(10) << "ram"
+      << std::setw(10) << "db_reads"
+      << std::setw(10) << "db_writes" << "\n";
+
+   int64_t base_cpu = 0, current_cpu = 0;
+   for (size_t i = 0; i < base.size(); ++i) {
+      const auto& b = base[i];
+      const auto& c = current[i];
+      if (!b.error.empty() || !c.error.empty()) {
+         os << std::setw(8) << i << "  " << (b.error.empty() ? "applied" : "failed") << " -> "
+            << (c.error.empty() ? "applied" : "failed") << "\n";
+         continue;
+      }
+      const int64_t cpu = int64_t(c.cpu_usage_us) - int64_t(b.cpu_usage_us);
+      base_cpu += b.cpu_usage_us;
+      current_cpu += c.cpu_usage_us;
+      os << std::setw(8) << i << std::setw(10) << cpu
+         << std::setw(10) << std::fixed << std::setprecision(1) << (b.cpu_usage_us ? 100.0 * cpu / b.cpu_usage_us : 0.0)
+         << std::setw(10) << c.ram_delta - b.ram_delta;
+      if (b.db_ops && c.db_ops) {
+         os << std::setw(10) << int64_t(c.db_reads()) - int64_t(b.db_reads())
+            << std::setw(10) << int64_t(c.db_writes()) - int64_t(b.db_writes());
+      } else {
+         os << std::setw(10) << "-" << std::setw(10) << "-";
+      }
+      os << "\n";
+   }
+   os << "cpu_us total " << base_cpu << " -> " << current_cpu;
+   if (base_cpu) os << " (" << std::fixed << std::setprecision(1) << 100.0 * (current_cpu - base_cpu) / base_cpu << "%)";
+   os << "\n";
+   os.flush();
+}
+
+} // namespace evm_test
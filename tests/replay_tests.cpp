@@ -0,0 +1,153 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cstdlib>
+
+#include "basic_evm_tester.hpp"
+#include "bench_utils.hpp"
+#include "replay.hpp"
+#include "simple_contract_tester.hpp"
+#include "state_export.hpp"
+
+using namespace evm_test;
+
+struct replay_source_tester : basic_evm_tester {
+
+   evm_eoa evm1;
+   evm_eoa evm2;
+   replay_recording recording;
+
+   replay_source_tester() {
+      create_accounts({"alice"_n});
+      transfer_token(faucet_account_name, "alice"_n, make_asset(10000'0000));
+      init();
+      setversion(1, evm_account_name);
+      produce_block();
+      produce_block();
+      transfer_token("alice"_n, evm_account_name, make_asset(100'0000), evm1.address_0x());
+      transfer_token("alice"_n, evm_account_name, make_asset(100'0000), evm2.address_0x());
+      recording.evm_version = 1;
+   }
+
+   // Push a transaction and keep its pushtx payload, the evmtx event must carry the same transaction
+   void record(evm_eoa& eoa, silkworm::Transaction& txn, uint64_t block) {
+      eoa.sign(txn);
+      auto trace = pushtx(txn);
+
+      std::optional<bytes> pushtx_data, evmtx_data;
+      for (const auto& at : trace->action_traces) {
+         if (at.act.name == "pushtx"_n) pushtx_data = at.act.data;
+         if (at.act.name == "evmtx"_n) evmtx_data = at.act.data;
+      }
+      BOOST_REQUIRE(pushtx_data && evmtx_data);
+      const auto rlptx = replay_recording::rlptx_from_pushtx(*pushtx_data);
+      BOOST_REQUIRE(rlptx == replay_recording::rlptx_from_evmtx(*evmtx_data));
+      recording.transactions.push_back({rlptx, block});
+   }
+
+   void record_call(evm_eoa& eoa, const evmc::address& to, const std::string& data_hex, uint64_t block) {
+      auto txn = generate_tx(to, 0, 1'000'000);
+      txn.data = evmc::from_hex(data_hex).value();
+      record(eoa, txn, block);
+   }
+
+   // Accounts keyed by address, ids depend on the order the rows were created
+   static std::map<std::string, std::string> by_address(const state_snapshot& snapshot) {
+      std::map<std::string, std::string> res;
+      for (const auto& a : snapshot.accounts) {
+         std::string v(reinterpret_cast<const char*>(&a.nonce), sizeof(a.nonce));
+         v.append(reinterpret_cast<const char*>(a.balance), sizeof(a.balance));
+         v.append(reinterpret_cast<const char*>(a.code_hash), sizeof(a.code_hash));
+         for (uint64_t i = 0; i < a.slot_count; ++i) {
+            const auto& s = snapshot.slots[a.first_slot + i];
+            v.append(reinterpret_cast<const char*>(s.key), sizeof(s.key));
+            v.append(reinterpret_cast<const char*>(s.value), sizeof(s.value));
+         }
+         res[std::string(reinterpret_cast<const char*>(a.address), sizeof(a.address))] = std::move(v);
+      }
+      return res;
+   }
+};
+
+BOOST_AUTO_TEST_SUITE(replay_tests)
+
+BOOST_FIXTURE_TEST_CASE(replay_roundtrip, replay_source_tester) try {
+
+   auto c1 = deploy_contract(evm1, evmc::from_hex(simple_bytecode).value());
+   auto setval = generate_tx(c1, 0, 1'000'000);
+   setval.data = evmc::from_hex(simple_contract_tester::setval(7)).value();
+   evm1.sign(setval);
+   pushtx(setval);
+   produce_block();
+
+   fc::temp_directory tmpdir;
+   recording.snapshot = (tmpdir.path() / "prestate.bin").string();
+   export_state(*this).write(recording.snapshot);
+
+   // Transactions after the export: a storage update, a transfer, a deployment and a call to the new contract
+   record_call(evm1, c1, simple_contract_tester::setval(8), 1);
+   auto transfer = generate_tx(evm2.address, 1_ether);
+   record(evm1, transfer, 1);
+   produce_block();
+
+   auto deploy = generate_tx(evmc::address{}, 0, 10'000'000);
+   deploy.to.reset();
+   deploy.data = evmc::from_hex(simple_bytecode).value();
+   const auto c2 = silkworm::create_address(evm2.address, evm2.next_nonce);
+   record(evm2, deploy, 2);
+   record_call(evm2, c2, simple_contract_tester::setval(9), 2);
+   produce_block();
+
+   const auto expected = by_address(export_state(*this));
+
+   const auto path = (tmpdir.path() / "recording.json").string();
+   recording.write(path);
+   const auto loaded = replay_recording::read(path);
+   BOOST_REQUIRE_EQUAL(loaded.snapshot, recording.snapshot);
+   BOOST_REQUIRE_EQUAL(loaded.transactions.size(), 4);
+
+   replay_tester t(loaded);
+   const auto samples = t.replay();
+   for (const auto& s : samples) {
+      BOOST_REQUIRE_MESSAGE(s.error.empty(), s.error);
+      BOOST_REQUIRE_GT(s.cpu_usage_us, 0);
+   }
+   BOOST_REQUIRE_GT(samples[2].ram_delta, 0); // <- new account and code rows
+   BOOST_REQUIRE(by_address(export_state(t)) == expected);
+
+   // A second replay of the same transactions is rejected (nonces already used)
+   for (const auto& s : t.replay()) {
+      BOOST_REQUIRE(!s.error.empty());
+   }
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(replay_bench_tests, EVM_BENCH_DECORATORS)
+
+// Replays a recorded workload with the contract of this tree and, when EVM_REPLAY_BASELINE_WASM is set, with another
+// build (its .abi next to it), then prints both runs and their difference:
+//    EVM_REPLAY_FILE=recording.json EVM_REPLAY_BASELINE_WASM=old/evm_runtime.wasm \
+//       ./unit_test --run_test=replay_bench_tests -- --eos-vm-oc
+// Build the contracts with WITH_DB_STATS to also get the table operations of each transaction.
+BOOST_AUTO_TEST_CASE(replay_file) try {
+   const char* file = std::getenv("EVM_REPLAY_FILE");
+   BOOST_REQUIRE_MESSAGE(file, "EVM_REPLAY_FILE must point to a recording");
+   const auto recording = replay_recording::read(file);
+
+   std::optional<std::vector<replay_sample>> baseline;
+   if (const char* wasm = std::getenv("EVM_REPLAY_BASELINE_WASM")) {
+      replay_tester t(recording, wasm);
+      baseline = t.replay();
+      print_replay(std::string("replay baseline ") + wasm, *baseline);
+   }
+
+   replay_tester t(recording);
+   const auto current = t.replay();
+   print_replay("replay current", current);
+
+   if (baseline) print_replay_diff(*baseline, current);
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
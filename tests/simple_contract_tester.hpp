@@ -0,0 +1,59 @@
+#pragma once
+
+#include <iomanip>
+#include <sstream>
+
+#include "basic_evm_tester.hpp"
+
+namespace evm_test {
+
+// Contract used by the gc, state export and replay tests:
+//
+// // SPDX-License-Identifier: GPL-3.0
+// pragma solidity >=0.7.0 <0.9.0;
+// contract Simple {
+//    uint256 val;
+//    address payable public owner;
+//    constructor() {
+//       owner = payable(msg.sender);
+//    }
+//    function setval(uint256 v) public {
+//       val=v;
+//    }
+//    function getval() public view returns (uint256) {
+//       return val;
+//    }
+//    function killme() public {
+//       selfdestruct(owner);
+//    }
+// }
+inline constexpr const char* simple_bytecode = "608060405234801561001057600080fd5b5033600160006101000a81548173ffffffffffffffffffffffffffffffffffffffff021916908373ffffffffffffffffffffffffffffffffffffffff16021790555061024b806100616000396000f3fe608060405234801561001057600080fd5b506004361061004c5760003560e01c806324d97a4a1461005157806331b6bd061461005b578063559c9c4a146100795780638da5cb5b14610095575b600080fd5b6100596100b3565b005b6100636100ee565b6040516100709190610140565b60405180910390f35b610093600480360381019061008e919061018c565b6100f7565b005b61009d610101565b6040516100aa91906101fa565b60405180910390f35b600160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff16ff5b60008054905090565b8060008190555050565b600160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1681565b6000819050919050565b61013a81610127565b82525050565b60006020820190506101556000830184610131565b92915050565b600080fd5b61016981610127565b811461017457600080fd5b50565b60008135905061018681610160565b92915050565b6000602082840312156101a2576101a161015b565b5b60006101b084828501610177565b91505092915050565b600073ffffffffffffffffffffffffffffffffffffffff82169050919050565b60006101e4826101b9565b9050919050565b6101f4816101d9565b82525050565b600060208201905061020f60008301846101eb565b9291505056fea26469706673582212204abac6746f4497f12044fdf4568905d560328e27fa03b3b954fc303865b8429764736f6c63430008120033";
+
+// alice funded, the contract initialized and evm1 holding 100 EOS
+struct simple_contract_tester : basic_evm_tester {
+
+   evm_eoa evm1;
+
+   simple_contract_tester() {
+      create_accounts({"alice"_n});
+      transfer_token(faucet_account_name, "alice"_n, make_asset(10000'0000));
+      init();
+      transfer_token("alice"_n, evm_account_name, make_asset(100'0000), evm1.address_0x());
+   }
+
+   void call(const evmc::address& to, const std::string& data_hex) {
+      auto txn = generate_tx(to, 0, 1'000'000);
+      txn.data = evmc::from_hex(data_hex).value();
+      evm1.sign(txn);
+      pushtx(txn);
+   }
+
+   // Call data of setval(v)
+   static std::string setval(uint64_t v) {
+      std::stringstream ss;
+      ss << "559c9c4a" << std::setfill('0') << std::setw(64) << std::hex << v;
+      return ss.str();
+   }
+};
+
+} // namespace evm_test
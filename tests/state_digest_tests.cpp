@@ -0,0 +1,210 @@
+#include <boost/test/unit_test.hpp>
+
+#include "basic_evm_tester.hpp"
+#include "utils.hpp"
+
+#include <ethash/keccak.hpp>
+
+using namespace evm_test;
+using eosio::testing::eosio_assert_message_is;
+
+struct state_digest_tester : basic_evm_tester {
+
+   // Init code storing 1 in slot 0 and 2 in slot 1, runtime code: CALLER SELFDESTRUCT
+   static constexpr const char* storing_bytecode = "600160005560026001556002601660003960026000f333ff";
+
+   evm_eoa evm1;
+   evm_eoa evm2;
+
+   state_digest_tester() {
+      create_accounts({"alice"_n});
+      transfer_token(faucet_account_name, "alice"_n, make_asset(10000'0000));
+      init();
+      transfer_token("alice"_n, evm_account_name, make_asset(100'0000), evm1.address_0x());
+   }
+
+   void call(const evmc::address& to, const intx::uint256& value = 0) {
+      auto txn = generate_tx(to, value, 1'000'000);
+      evm1.sign(txn);
+      pushtx(txn);
+   }
+
+   // getdigest is pushed as a transaction, avoid duplicates when the state did not change
+   intx::uint256 digest(const std::optional<evmc::address>& address = std::nullopt) {
+      produce_block();
+      return getdigest(address);
+   }
+
+   static intx::uint256 leaf(const silkworm::Bytes& preimage) {
+      return intx::be::load<intx::uint256>(ethash::keccak256(preimage.data(), preimage.size()));
+   }
+
+   static silkworm::Bytes word(const intx::uint256& v) {
+      uint8_t buffer[32];
+      intx::be::store(buffer, v);
+      return silkworm::Bytes{buffer, sizeof(buffer)};
+   }
+
+   // Reference computation from the contract tables, the way an off-chain node would do it
+   intx::uint256 reference_digest(const account_object& account) const {
+      std::map<uint64_t, bytes> code_hashes;
+      scan_account_code([&](account_code row) -> bool {
+         code_hashes[row.id] = row.code_hash;
+         return false;
+      });
+
+      silkworm::Bytes preimage{0x01};
+      preimage += silkworm::Bytes{account.address.bytes, sizeof(account.address.bytes)};
+      for (int i = 0; i < 8; ++i) {
+         preimage.push_back(static_cast<uint8_t>(account.nonce >> (56 - 8 * i)));
+      }
+      preimage += word(account.balance);
+      if (account.code_id) {
+         const auto& code_hash = code_hashes.at(*account.code_id);
+         preimage += silkworm::Bytes{reinterpret_cast<const uint8_t*>(code_hash.data()), code_hash.size()};
+      } else {
+         preimage += silkworm::Bytes{silkworm::kEmptyHash.bytes, sizeof(silkworm::kEmptyHash.bytes)};
+      }
+      intx::uint256 res = leaf(preimage);
+
+      scan_account_storage(account.id, [&](storage_slot slot) -> bool {
+         silkworm::Bytes preimage{0x02};
+         preimage += silkworm::Bytes{account.address.bytes, sizeof(account.address.bytes)};
+         preimage += word(slot.key);
+         preimage += word(slot.value);
+         res += leaf(preimage);
+         return false;
+      });
+      return res;
+   }
+
+   intx::uint256 reference_digest() const {
+      intx::uint256 res = 0;
+      scan_accounts([&](account_object account) -> bool {
+         res += reference_digest(account);
+         return false;
+      });
+      return res;
+   }
+};
+
+BOOST_AUTO_TEST_SUITE(state_digest_tests)
+
+BOOST_FIXTURE_TEST_CASE(digest_follows_state, state_digest_tester) try {
+
+   BOOST_REQUIRE(digest() != 0);
+   BOOST_REQUIRE(digest() == reference_digest());
+
+   // EOA to EOA
+   call(evm2.address, 1_ether);
+   BOOST_REQUIRE(digest() == reference_digest());
+
+   // Contracts with code and storage
+   auto c1 = deploy_contract(evm1, evmc::from_hex(storing_bytecode).value());
+   auto c2 = deploy_contract(evm1, evmc::from_hex(storing_bytecode).value());
+   BOOST_REQUIRE(digest() == reference_digest());
+
+   // Self destruct: the storage rows wait for gc but are no longer part of the digest
+   call(c1);
+   BOOST_REQUIRE(!find_account_by_address(c1).has_value());
+   BOOST_REQUIRE(digest() == reference_digest());
+
+   gc(100);
+   BOOST_REQUIRE(digest() == reference_digest());
+
+   // Per account digests add up to the global one
+   std::vector<account_object> accounts;
+   scan_accounts([&](account_object account) -> bool {
+      accounts.push_back(account);
+      return false;
+   });
+   intx::uint256 sum = 0;
+   for (const auto& account : accounts) {
+      auto d = digest(account.address);
+      BOOST_REQUIRE(d == reference_digest(account));
+      sum += d;
+   }
+   BOOST_REQUIRE(sum == digest());
+   BOOST_REQUIRE(digest(c1) == 0);
+   BOOST_REQUIRE(digest(c2) != 0);
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(digest_follows_admin_actions, state_digest_tester) try {
+
+   auto c1 = deploy_contract(evm1, evmc::from_hex(storing_bytecode).value());
+   auto c2 = deploy_contract(evm1, evmc::from_hex(storing_bytecode).value());
+   const uint64_t c1_id = find_account_by_address(c1).value().id;
+   const uint64_t c2_id = find_account_by_address(c2).value().id;
+
+   setkvstore(c1_id, to_bytes(intx::uint256(0)), to_bytes(intx::uint256(55)));
+   BOOST_REQUIRE(digest() == reference_digest());
+
+   setkvstore(c1_id, to_bytes(intx::uint256(7)), to_bytes(intx::uint256(8)));
+   BOOST_REQUIRE(digest() == reference_digest());
+
+   setkvstore(c1_id, to_bytes(intx::uint256(1)), {});
+   BOOST_REQUIRE(digest() == reference_digest());
+
+   addevmbal(c2_id, 1_ether, false);
+   BOOST_REQUIRE(digest() == reference_digest());
+
+   rmaccount(c1_id);
+   BOOST_REQUIRE(digest() == reference_digest());
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(seed_existing_state, state_digest_tester) try {
+
+   call(evm2.address, 1_ether);
+   auto c1 = deploy_contract(evm1, evmc::from_hex(storing_bytecode).value());
+   auto c2 = deploy_contract(evm1, evmc::from_hex(storing_bytecode).value());
+   const uint64_t c1_id = find_account_by_address(c1).value().id;
+   const uint64_t c2_id = find_account_by_address(c2).value().id;
+   setkvstore(c2_id, to_bytes(intx::uint256(7)), to_bytes(intx::uint256(8)));
+
+   // Start over, like a contract initialized before the digest existed
+   resetdigest();
+   BOOST_REQUIRE_EXCEPTION(getdigest(), eosio_assert_message_exception,
+                           eosio_assert_message_is("state digest is still being seeded"));
+
+   // One row per call, the state keeps changing in accounts already walked, being walked and not reached yet
+   uint64_t step = 0;
+   while (!seeddigest(1)) {
+      ++step;
+      call(evm2.address, 1);
+      setkvstore(c1_id, to_bytes(intx::uint256(step % 2)), to_bytes(intx::uint256(step + 10)));
+      setkvstore(c2_id, to_bytes(intx::uint256(1)), to_bytes(intx::uint256(step + 10)));
+      if (step == 3) {
+         // a row erased while seeding, recreated with a new id by the next even step
+         setkvstore(c1_id, to_bytes(intx::uint256(0)), {});
+      }
+      produce_block();
+   }
+   BOOST_REQUIRE(step > 5);
+   BOOST_REQUIRE(digest() == reference_digest());
+
+   std::vector<account_object> accounts;
+   scan_accounts([&](account_object account) -> bool {
+      accounts.push_back(account);
+      return false;
+   });
+   intx::uint256 sum = 0;
+   for (const auto& account : accounts) {
+      auto d = digest(account.address);
+      BOOST_REQUIRE(d == reference_digest(account));
+      sum += d;
+   }
+   BOOST_REQUIRE(sum == digest());
+
+   BOOST_REQUIRE_EXCEPTION(seeddigest(1), eosio_assert_message_exception,
+                           eosio_assert_message_is("state digest is already seeded"));
+
+   // Tracked like from genesis on
+   call(c1);
+   setkvstore(c2_id, to_bytes(intx::uint256(9)), to_bytes(intx::uint256(9)));
+   BOOST_REQUIRE(digest() == reference_digest());
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstring>
+#include <fstream>
+
+#include "basic_evm_tester.hpp"
+
+// Reference exporter for the exportaccts/exportcode/exportstore actions.
+//
+// It pages through the whole EVM state and writes a snapshot file made only of fixed size records, in host byte
+// order, so that a node can mmap it and index the sections directly:
+//
+//    snapshot_header
+//    snapshot_account[header.accounts]   ordered by id
+//    snapshot_slot[header.slots]         grouped by account, see snapshot_account::first_slot
+//    snapshot_code[header.codes]
+//    uint8_t[header.code_bytes]          code blobs, see snapshot_code::offset
+
+namespace evm_test {
+
+struct snapshot_header {
+   char     magic[8];
+   uint64_t accounts;
+   uint64_t slots;
+   uint64_t codes;
+   uint64_t code_bytes;
+};
+
+struct snapshot_account {
+   uint64_t id;
+   uint8_t  address[20];
+   uint8_t  has_code;
+   uint8_t  padding[3];
+   uint64_t nonce;
+   uint8_t  balance[32];
+   uint8_t  code_hash[32];
+   uint64_t first_slot;
+   uint64_t slot_count;
+};
+
+struct snapshot_slot {
+   uint8_t key[32];
+   uint8_t value[32];
+};
+
+struct snapshot_code {
+   uint8_t  code_hash[32];
+   uint64_t offset; // <- from the start of the code blobs
+   uint64_t size;
+};
+
+static_assert(sizeof(snapshot_header) == 40);
+static_assert(sizeof(snapshot_account) == 120);
+static_assert(sizeof(snapshot_slot) == 64);
+static_assert(sizeof(snapshot_code) == 48);
+
+inline constexpr char snapshot_magic[8] = {'E', 'V', 'M', 'S', 'N', 'A', 'P', '1'};
+
+struct state_snapshot {
+   std::vector<snapshot_account> accounts;
+   std::vector<snapshot_slot>    slots;
+   std::vector<snapshot_code>    codes;
+   std::vector<uint8_t>          code_blobs;
+
+   void write(const std::string& path) const {
+      snapshot_header header{};
+      std::memcpy(header.magic, snapshot_magic, sizeof(header.magic));
+      header.accounts = accounts.size();
+      header.slots = slots.size();
+      header.codes = codes.size();
+      header.code_bytes = code_blobs.size();
+
+      std::ofstream out(path, std::ios::binary | std::ios::trunc);
+      BOOST_REQUIRE(out);
+      out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      out.write(reinterpret_cast<const char*>(accounts.data()), accounts.size() * sizeof(snapshot_account));
+      out.write(reinterpret_cast<const char*>(slots.data()), slots.size() * sizeof(snapshot_slot));
+      out.write(reinterpret_cast<const char*>(codes.data()), codes.size() * sizeof(snapshot_code));
+      out.write(reinterpret_cast<const char*>(code_blobs.data()), code_blobs.size());
+      BOOST_REQUIRE(out);
+   }
+
+   // Same view a node would get by mmap'ing the file
+   static state_snapshot read(const std::string& path) {
+      std::ifstream in(path, std::ios::binary);
+      BOOST_REQUIRE(in);
+      std::vector<char> file{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+      BOOST_REQUIRE(file.size() >= sizeof(snapshot_header));
+
+      const auto* header = reinterpret_cast<const snapshot_header*>(file.data());
+      BOOST_REQUIRE(std::memcmp(header->magic, snapshot_magic, sizeof(snapshot_magic)) == 0);
+      BOOST_REQUIRE_EQUAL(file.size(), sizeof(snapshot_header) + header->accounts * sizeof(snapshot_account) +
+                                          header->slots * sizeof(snapshot_slot) + header->codes * sizeof(snapshot_code) +
+                                          header->code_bytes);
+
+      state_snapshot res;
+      const char* p = file.data() + sizeof(snapshot_header);
+      auto section = [&](auto& v, size_t count) {
+         using T = typename std::decay_t<decltype(v)>::value_type;
+         const T* first = reinterpret_cast<const T*>(p);
+         v.assign(first, first + count);
+         p += count * sizeof(T);
+      };
+      section(res.accounts, header->accounts);
+      section(res.slots, header->slots);
+      section(res.codes, header->codes);
+      section(res.code_blobs, header->code_bytes);
+      return res;
+   }
+};
+
+template <size_t N>
+void copy_exported(uint8_t (&dst)[N], const bytes& src) {
+   BOOST_REQUIRE(src.size() <= N);
+   std::memset(dst, 0, N);
+   std::memcpy(dst + N - src.size(), src.data(), src.size());
+}
+
+// max_bytes must stay below the max_action_return_value_size of the chain (256 bytes by default)
+inline state_snapshot export_state(basic_evm_tester& t, uint32_t max_bytes = 256) {
+   state_snapshot res;
+
+   std::optional<uint64_t> cursor = 0;
+   while (cursor) {
+      auto page = t.exportaccts(*cursor, max_bytes);
+      for (const auto& a : page.accounts) {
+         snapshot_account row{};
+         row.id = a.id;
+         copy_exported(row.address, a.address);
+         row.has_code = !a.code_hash.empty();
+         row.nonce = a.nonce;
+         copy_exported(row.balance, a.balance);
+         if (row.has_code) copy_exported(row.code_hash, a.code_hash);
+
+         row.first_slot = res.slots.size();
+         std::optional<uint64_t> slot_cursor = 0;
+         while (slot_cursor) {
+            auto slots = t.exportstore(a.id, *slot_cursor, max_bytes);
+            for (const auto& s : slots.slots) {
+               snapshot_slot slot{};
+               copy_exported(slot.key, s.key);
+               copy_exported(slot.value, s.value);
+               res.slots.push_back(slot);
+            }
+            slot_cursor = slots.next;
+         }
+         row.slot_count = res.slots.size() - row.first_slot;
+         res.accounts.push_back(row);
+      }
+      cursor = page.next;
+   }
+
+   cursor = 0;
+   uint32_t offset = 0;
+   while (cursor) {
+      auto page = t.exportcode(*cursor, offset, max_bytes);
+      for (const auto& c : page.codes) {
+         if (c.offset == 0) {
+            snapshot_code row{};
+            copy_exported(row.code_hash, c.code_hash);
+            row.offset = res.code_blobs.size();
+            row.size = c.size;
+            res.codes.push_back(row);
+         }
+         BOOST_REQUIRE(!res.codes.empty() && res.code_blobs.size() == res.codes.back().offset + c.offset);
+         res.code_blobs.insert(res.code_blobs.end(), c.data.begin(), c.data.end());
+      }
+      cursor = page.next;
+      offset = page.next_offset;
+   }
+
+   return res;
+}
+
+} // namespace evm_test
@@ -0,0 +1,137 @@
+#include <boost/test/unit_test.hpp>
+
+#include "simple_contract_tester.hpp"
+#include "state_export.hpp"
+#include "utils.hpp"
+
+using namespace evm_test;
+using eosio::testing::eosio_assert_message_is;
+
+struct state_export_tester : simple_contract_tester {
+
+   evm_eoa evm2;
+
+   static intx::uint256 load(const uint8_t (&v)[32]) {
+      return intx::be::unsafe::load<intx::uint256>(v);
+   }
+
+   // Compare a snapshot with the contract tables
+   void check_snapshot(const state_snapshot& snapshot) const {
+      std::map<uint64_t, account_code> codes;
+      scan_account_code([&](account_code row) -> bool {
+         codes[row.id] = row;
+         return false;
+      });
+
+      size_t i = 0;
+      scan_accounts([&](account_object account) -> bool {
+         BOOST_REQUIRE(i < snapshot.accounts.size());
+         const auto& row = snapshot.accounts[i++];
+         BOOST_REQUIRE_EQUAL(row.id, account.id);
+         BOOST_REQUIRE(std::memcmp(row.address, account.address.bytes, sizeof(row.address)) == 0);
+         BOOST_REQUIRE_EQUAL(row.nonce, account.nonce);
+         BOOST_REQUIRE(load(row.balance) == account.balance);
+         BOOST_REQUIRE_EQUAL(static_cast<bool>(row.has_code), account.code_id.has_value());
+         if (account.code_id) {
+            const auto& code_hash = codes.at(*account.code_id).code_hash;
+            BOOST_REQUIRE(std::memcmp(row.code_hash, code_hash.data(), sizeof(row.code_hash)) == 0);
+         }
+
+         size_t j = row.first_slot;
+         scan_account_storage(account.id, [&](storage_slot slot) -> bool {
+            BOOST_REQUIRE(j < row.first_slot + row.slot_count);
+            BOOST_REQUIRE(load(snapshot.slots[j].key) == slot.key);
+            BOOST_REQUIRE(load(snapshot.slots[j].value) == slot.value);
+            ++j;
+            return false;
+         });
+         BOOST_REQUIRE_EQUAL(j, row.first_slot + row.slot_count);
+         return false;
+      });
+      BOOST_REQUIRE_EQUAL(i, snapshot.accounts.size());
+
+      BOOST_REQUIRE_EQUAL(snapshot.codes.size(), codes.size());
+      i = 0;
+      for (const auto& [id, code] : codes) {
+         const auto& row = snapshot.codes[i++];
+         BOOST_REQUIRE(std::memcmp(row.code_hash, code.code_hash.data(), sizeof(row.code_hash)) == 0);
+         BOOST_REQUIRE_EQUAL(row.size, code.code.size());
+         BOOST_REQUIRE(std::equal(code.code.begin(), code.code.end(), snapshot.code_blobs.begin() + row.offset,
+                                  [](char a, uint8_t b) { return static_cast<uint8_t>(a) == b; }));
+      }
+   }
+};
+
+BOOST_AUTO_TEST_SUITE(state_export_tests)
+
+BOOST_FIXTURE_TEST_CASE(export_pages, state_export_tester) try {
+
+   auto c1 = deploy_contract(evm1, evmc::from_hex(simple_bytecode).value());
+   call(c1, setval(7));
+   produce_block();
+
+   // Each page stays under the byte budget and the cursors walk every row
+   size_t accounts = 0;
+   std::optional<uint64_t> cursor = 0;
+   while (cursor) {
+      auto page = exportaccts(*cursor, 128);
+      BOOST_REQUIRE(!page.accounts.empty());
+      BOOST_REQUIRE_LE(fc::raw::pack_size(page), 128);
+      accounts += page.accounts.size();
+      cursor = page.next;
+   }
+   size_t expected = 0;
+   scan_accounts([&](account_object) -> bool {
+      ++expected;
+      return false;
+   });
+   BOOST_REQUIRE_EQUAL(accounts, expected);
+
+   // The Simple contract code does not fit in one page
+   auto page = exportcode(0, 0, 256);
+   BOOST_REQUIRE_EQUAL(page.codes.size(), 1);
+   BOOST_REQUIRE_LE(fc::raw::pack_size(page), 256);
+   BOOST_REQUIRE(page.next.has_value());
+   BOOST_REQUIRE_EQUAL(page.next_offset, page.codes[0].data.size());
+
+   auto c1_id = find_account_by_address(c1).value().id;
+   auto slots = exportstore(c1_id, 0, 256);
+   BOOST_REQUIRE_EQUAL(slots.slots.size(), 2);
+   BOOST_REQUIRE(!slots.next.has_value());
+
+   // Pages filled up to the budget still fit once the framing (vector size, cursors) is added
+   for (uint32_t max_bytes = 120; max_bytes <= 400; max_bytes += 7) {
+      BOOST_REQUIRE_LE(fc::raw::pack_size(exportcode(0, 0, max_bytes)), max_bytes);
+      BOOST_REQUIRE_LE(fc::raw::pack_size(exportaccts(0, max_bytes)), max_bytes);
+      BOOST_REQUIRE_LE(fc::raw::pack_size(exportstore(c1_id, 0, max_bytes)), max_bytes);
+   }
+
+   BOOST_REQUIRE_EXCEPTION(exportaccts(0, 16),
+      eosio_assert_message_exception, eosio_assert_message_is("max_bytes too small"));
+   BOOST_REQUIRE_EXCEPTION(exportcode(0, 10'000, 256),
+      eosio_assert_message_exception, eosio_assert_message_is("offset out of range"));
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(export_snapshot, state_export_tester) try {
+
+   auto c1 = deploy_contract(evm1, evmc::from_hex(simple_bytecode).value());
+   auto c2 = deploy_contract(evm1, evmc::from_hex(simple_bytecode).value());
+   call(c1, setval(7));
+   call(c2, setval(8));
+   transfer_token("alice"_n, evm_account_name, make_asset(1'0000), evm2.address_0x());
+   produce_block();
+
+   auto snapshot = export_state(*this);
+   check_snapshot(snapshot);
+   BOOST_REQUIRE_EQUAL(snapshot.codes.size(), 1); // <- both contracts share the same code
+
+   fc::temp_directory tmpdir;
+   auto path = (tmpdir.path() / "snapshot.bin").string();
+   snapshot.write(path);
+   auto loaded = state_snapshot::read(path);
+   check_snapshot(loaded);
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
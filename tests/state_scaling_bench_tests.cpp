@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <sstream>
+
+#include "bench_utils.hpp"
+
+using namespace evm_test;
+
+// Measures how the CPU of account and storage lookups grows with the size of the state: the account table and the
+// storage of one token contract are grown with importstate to each size, then the same workloads are measured.
+//
+// Inputs (environment):
+//    EVM_SCALE_SIZES     comma separated account (and token holder) counts (default 10000,100000,1000000)
+//    EVM_SCALE_SAMPLES   transactions measured per workload and size, the median is reported (default 21)
+//
+//    EVM_SCALE_SIZES=10000,100000,1000000,10000000 ./unit_test --run_test=state_scaling_bench_tests -- --eos-vm-oc
+struct state_scaling_tester : basic_evm_tester {
+
+   static constexpr uint32_t import_accounts = 400; // <- plus as many token slots, under max_import_rows
+
+   evm_eoa       evm1;
+   evmc::address token;
+   bytes         token_code_hash;
+   uint64_t      populated = 0;
+   std::mt19937_64 rng{1153};
+
+   state_scaling_tester() {
+      create_accounts({"alice"_n});
+      transfer_token(faucet_account_name, "alice"_n, make_asset(10000'0000));
+      init();
+      transfer_token("alice"_n, evm_account_name, make_asset(5000'0000), evm1.address_0x());
+
+      const auto runtime = evmc::from_hex(token_runtime).value();
+      token = deploy_contract(evm1, make_init_code(runtime, evmc::from_hex(token_mint).value()));
+      const auto h = ethash::keccak256(runtime.data(), runtime.size());
+      token_code_hash = bytes(std::begin(h.bytes), std::end(h.bytes));
+      produce_block();
+   }
+
+   static uint64_t env(const char* name, uint64_t def) {
+      const char* v = std::getenv(name);
+      return v ? std::stoull(v) : def;
+   }
+
+   static std::vector<uint64_t> sizes() {
+      const char* v = std::getenv("EVM_SCALE_SIZES");
+      std::istringstream in(v ? v : "10000,100000,1000000");
+      std::vector<uint64_t> res;
+      for (std::string s; std::getline(in, s, ',');) res.push_back(std::stoull(s));
+      std::sort(res.begin(), res.end());
+      return res;
+   }
+
+   static evmc::address holder(uint64_t i) {
+      evmc::address res;
+      res.bytes[0] = 0x11;
+      for (int b = 0; b < 8; ++b) res.bytes[19 - b] = static_cast<uint8_t>(i >> (8 * b));
+      return res;
+   }
+
+   // Adds accounts and token holders up to size
+   void populate(uint64_t size) {
+      const auto account = find_account_by_address(token).value();
+      uint64_t batches = 0;
+      while (populated < size) {
+         state_batch batch;
+         imported_account token_row{to_bytes(token), account.nonce, to_bytes(account.balance), token_code_hash, {}};
+         const uint64_t end = std::min(size, populated + import_accounts);
+         for (uint64_t i = populated; i < end; ++i) {
+            batch.accounts.push_back({to_bytes(holder(i)), 0, to_bytes(intx::uint256{1'000'000'000}), std::nullopt, {}});
+            token_row.storage.push_back({to_bytes(token_balance_slot(holder(i))), to_bytes(intx::uint256{1'000'000})});
+         }
+         batch.accounts.push_back(std::move(token_row));
+         importstate(batch);
+         populated = end;
+         if (++batches % 16 == 0) produce_block();
+      }
+      produce_block();
+   }
+
+   evmc::address random_holder() {
+      return holder(std::uniform_int_distribution<uint64_t>(0, populated - 1)(rng));
+   }
+
+   // Median by billed CPU, each sample in its own block so that identical actions are never rejected as duplicates
+   bench_sample median(std::string name, const std::function<bench_sample()>& measure) {
+      std::vector<bench_sample> samples;
+      const auto count = std::max<uint64_t>(1, env("EVM_SCALE_SAMPLES", 21));
+      for (uint64_t i = 0; i < count; ++i) {
+         samples.push_back(measure());
+         produce_block();
+      }
+      std::sort(samples.begin(), samples.end(),
+                [](const auto& a, const auto& b) { return a.cpu_usage_us < b.cpu_usage_us; });
+      auto res = samples[samples.size() / 2];
+      res.name = std::move(name);
+      return res;
+   }
+
+   void measure(bench_report& report) {
+      const auto suffix = " @ " + std::to_string(populated);
+
+      report.add(median("pushtx transfer to existing account" + suffix, [&] {
+         auto txn = generate_tx(random_holder(), 1);
+         evm1.sign(txn);
+         return make_bench_sample("", pushtx(txn), 21'000);
+      }));
+
+      report.add(median("pushtx erc20 transfer" + suffix, [&] {
+         return measure_call(*this, evm1, "", token, token_transfer_data(random_holder(), 1), 100'000);
+      }));
+
+      // Two random slots read and written, nothing committed
+      report.add(median("exec erc20 transfer" + suffix, [&] {
+         exec_input input;
+         input.from = to_bytes(random_holder());
+         input.to = to_bytes(token);
+         const auto data = token_transfer_data(random_holder(), 1);
+         input.data = bytes(data.begin(), data.end());
+         return make_bench_sample("", exec(input, {}));
+      }));
+   }
+};
+
+BOOST_AUTO_TEST_SUITE(state_scaling_bench_tests, EVM_BENCH_DECORATORS)
+
+BOOST_FIXTURE_TEST_CASE(account_and_storage_lookups, state_scaling_tester) try {
+   bench_report report("state size scaling");
+   for (auto size : sizes()) {
+      const auto start = fc::time_point::now();
+      populate(size);
+      std::cout << "populated " << populated << " accounts and token holders in "
+                << (fc::time_point::now() - start).count() / 1'000'000 << " s" << std::endl;
+      measure(report);
+   }
+   report.print();
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
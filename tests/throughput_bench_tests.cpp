@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+
+#include "bench_utils.hpp"
+
+using namespace evm_test;
+
+// Fills Antelope blocks with pushtx transactions until max_block_cpu_usage is reached, for several transaction mixes,
+// to tell how many EVM transactions of each kind fit in a block.
+//
+// Inputs (environment):
+//    EVM_TPS_SENDERS   number of EVM accounts signing the transactions, round robin (default 64)
+//    EVM_TPS_BLOCKS    blocks filled per mix (default 3)
+//
+//    ./unit_test --run_test=throughput_bench_tests -- --eos-vm-oc
+struct throughput_tester : basic_evm_tester {
+
+   // Runtime of a constant product pool selling its tokens for the value of the call: out = r1 * value / (r0 + value),
+   // reserves in slots 0 and 1, balances of the buyers in a mapping at slot 2
+   static constexpr const char* swap_code = "346000546001548281028383019004808203600155838301600055336000526002602052604060002080548201905500";
+   // Constructor of the pool: both reserves at 2^100
+   static constexpr const char* swap_reserves = "6c100000000000000000000000006000556c10000000000000000000000000600155";
+
+   enum class tx_kind { transfer, erc20, swap, deploy };
+
+   struct mix {
+      std::string                              name;
+      std::vector<std::pair<tx_kind, uint32_t>> weights;
+   };
+
+   struct block_result {
+      uint64_t              txs    = 0;
+      uint64_t              cpu_us = 0;
+      std::vector<uint64_t> tx_cpu_us;
+      std::vector<int64_t>  tx_elapsed_us;
+      std::string           stop_reason;
+   };
+
+   std::vector<std::unique_ptr<evm_eoa>> senders;
+   evmc::address token;
+   evmc::address pool;
+   uint64_t next_tx = 0;
+
+   throughput_tester() {
+      create_accounts({"alice"_n});
+      transfer_token(faucet_account_name, "alice"_n, make_asset(1'000'000'0000));
+      init();
+
+      const auto sender_count = std::max<size_t>(2, env("EVM_TPS_SENDERS", 64));
+      for (size_t i = 0; i < sender_count; ++i) {
+         senders.emplace_back(std::make_unique<evm_eoa>());
+         transfer_token("alice"_n, evm_account_name, make_asset(1000'0000), senders.back()->address_0x());
+      }
+      produce_block();
+
+      token = deploy_contract(*senders[0], make_init_code(evmc::from_hex(token_runtime).value(), evmc::from_hex(token_mint).value()));
+      pool = deploy_contract(*senders[0], make_init_code(evmc::from_hex(swap_code).value(), evmc::from_hex(swap_reserves).value()));
+      for (size_t i = 1; i < senders.size(); ++i) {
+         auto txn = make_tx(tx_kind::erc20, senders[i]->address, 1'000'000'000);
+         senders[0]->sign(txn);
+         pushtx(txn);
+      }
+      produce_block();
+   }
+
+   static uint64_t env(const char* name, uint64_t def) {
+      const char* v = std::getenv(name);
+      return v ? std::stoull(v) : def;
+   }
+
+   silkworm::Transaction make_tx(tx_kind kind, const evmc::address& to, uint64_t amount = 1) {
+      switch (kind) {
+         case tx_kind::transfer:
+            return generate_tx(to, amount);
+         case tx_kind::erc20: {
+            auto txn = generate_tx(token, 0, 100'000);
+            txn.data = token_transfer_data(to, amount);
+            return txn;
+         }
+         case tx_kind::swap:
+            return generate_tx(pool, intx::uint256{amount} * 1'000'000'000, 100'000);
+         case tx_kind::deploy: {
+            auto txn = generate_tx(evmc::address{}, 0, 2'000'000);
+            txn.to.reset();
+            txn.data = make_init_code(evmc::from_hex(token_runtime).value(), evmc::from_hex(token_mint).value());
+            return txn;
+         }
+      }
+      BOOST_FAIL("unknown transaction kind");
+      return {};
+   }
+
+   // Weighted round robin over the kinds of the mix, senders taken in turn
+   tx_kind pick(const mix& m) {
+      uint64_t total = 0;
+      for (const auto& [kind, weight] : m.weights) total += weight;
+      uint64_t slot = next_tx % total;
+      for (const auto& [kind, weight] : m.weights) {
+         if (slot < weight) return kind;
+         slot -= weight;
+      }
+      return m.weights.front().first;
+   }
+
+   block_result fill_block(const mix& m) {
+      const auto max_block_cpu = control->get_global_properties().configuration.max_block_cpu_usage;
+
+      block_result res;
+      // Over the block (or transaction) CPU limit: the nonce was not used
+      auto stop = [&](evm_eoa& from, const fc::exception& e) {
+         from.next_nonce--;
+         res.stop_reason = e.top_message();
+      };
+
+      uint64_t max_tx_cpu = 0;
+      while (res.cpu_us + max_tx_cpu <= max_block_cpu) {
+         auto& from = *senders[next_tx % senders.size()];
+         const auto& to = senders[(next_tx + 1) % senders.size()]->address;
+         auto txn = make_tx(pick(m), to);
+         ++next_tx;
+
+         from.sign(txn);
+         try {
+            auto trace = pushtx(txn);
+            const auto cpu = trace->receipt->cpu_usage_us;
+            res.cpu_us += cpu;
+            res.tx_cpu_us.push_back(cpu);
+            res.tx_elapsed_us.push_back(trace->elapsed.count());
+            max_tx_cpu = std::max<uint64_t>(max_tx_cpu, cpu);
+            ++res.txs;
+         } catch (const block_cpu_usage_exceeded& e) {
+            stop(from, e);
+            break;
+         } catch (const tx_cpu_usage_exceeded& e) {
+            stop(from, e);
+            break;
+         } catch (const deadline_exception& e) {
+            stop(from, e);
+            break;
+         } catch (...) {
+            // Any other failure is a broken benchmark, not a full block
+            from.next_nonce--;
+            throw;
+         }
+      }
+      if (res.stop_reason.empty()) res.stop_reason = "next transaction may not fit";
+      produce_block();
+      return res;
+   }
+
+   template <typename T>
+   static T percentile(std::vector<T> v, double p) {
+      if (v.empty()) return 0;
+      std::sort(v.begin(), v.end());
+      return v[std::min(v.size() - 1, static_cast<size_t>(p * v.size()))];
+   }
+
+   void run(const mix& m, std::ostream& os = std::cout) {
+      const auto blocks = std::max<uint64_t>(1, env("EVM_TPS_BLOCKS", 3));
+      const auto& cfg = control->get_global_properties().configuration;
+
+      os << "\n== " << m.name << " (max_block_cpu_usage " << cfg.max_block_cpu_usage << " us, "
+         << senders.size() << " senders) ==\n";
+      os << std::right << std::setw(8) << "block" << std::setw(10) << "txs" << std::setw(12) << "cpu_us"
+         << "  stop reason\n";
+
+      uint64_t txs = 0, cpu = 0;
+      std::vector<uint64_t> tx_cpu;
+      std::vector<int64_t>  tx_elapsed;
+      for (uint64_t b = 0; b < blocks; ++b) {
+         auto r = fill_block(m);
+         os << std::setw(8) << b << std::setw(10) << r.txs << std::setw(12) << r.cpu_us << "  " << r.stop_reason << "\n";
+         BOOST_REQUIRE_MESSAGE(r.txs > 0, r.stop_reason);
+         txs += r.txs;
+         cpu += r.cpu_us;
+         tx_cpu.insert(tx_cpu.end(), r.tx_cpu_us.begin(), r.tx_cpu_us.end());
+         tx_elapsed.insert(tx_elapsed.end(), r.tx_elapsed_us.begin(), r.tx_elapsed_us.end());
+      }
+
+      const double txs_per_block = double(txs) / blocks;
+      os << std::fixed << std::setprecision(1)
+         << "txs/block " << txs_per_block
+         << ", tps " << txs_per_block * 1000 / eosio::chain::config::block_interval_ms
+         << ", cpu_us/block " << double(cpu) / blocks
+         << ", tx cpu_us p50 " << percentile(tx_cpu, 0.5) << " p99 " << percentile(tx_cpu, 0.99)
+         << " max " << percentile(tx_cpu, 1.0)
+         << ", tx elapsed_us p50 " << percentile(tx_elapsed, 0.5) << " p99 " << percentile(tx_elapsed, 0.99)
+         << " max " << percentile(tx_elapsed, 1.0) << "\n";
+      os.flush();
+   }
+};
+
+BOOST_AUTO_TEST_SUITE(throughput_bench_tests, EVM_BENCH_DECORATORS)
+
+BOOST_FIXTURE_TEST_CASE(transfers, throughput_tester) try {
+   run({"native value transfers", {{tx_kind::transfer, 1}}});
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(erc20_transfers, throughput_tester) try {
+   run({"erc20 transfers", {{tx_kind::erc20, 1}}});
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(swaps, throughput_tester) try {
+   run({"swaps", {{tx_kind::swap, 1}}});
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(deploys, throughput_tester) try {
+   run({"deploys", {{tx_kind::deploy, 1}}});
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(mixed, throughput_tester) try {
+   run({"mixed 40% transfers, 30% erc20, 20% swaps, 10% deploys",
+        {{tx_kind::transfer, 4}, {tx_kind::erc20, 3}, {tx_kind::swap, 2}, {tx_kind::deploy, 1}}});
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,4 +1,5 @@
 #include "basic_evm_tester.hpp"
+#include "utils.hpp"
 #include <silkworm/core/execution/address.hpp>
 #include <silkworm/core/types/transaction.hpp>
 #include <eosevm/block_mapping.hpp>
@@ -612,4 +613,82 @@ BOOST_FIXTURE_TEST_CASE(min_inclusion_price, version_tester) try {
 
 } FC_LOG_AND_RETHROW()
 
+BOOST_FIXTURE_TEST_CASE(state_diff_event, version_tester) try {
+
+    evm_eoa evm1;
+    const int64_t to_bridge = 1000000;
+
+    auto evmtx_data = [](const transaction_trace_ptr& trace) {
+        auto it = std::find_if(trace->action_traces.begin(), trace->action_traces.end(), [](const auto& at) {
+            return at.act.name == "evmtx"_n;
+        });
+        BOOST_REQUIRE(it != trace->action_traces.end());
+        return it->act.data;
+    };
+
+    auto find_change = [](const evm_test::evmtx_v4& event, auto pred) {
+        return std::find_if(event.state_diff.begin(), event.state_diff.end(), pred);
+    };
+
+    BOOST_REQUIRE_EXCEPTION(setstatediff(true, "alice"_n),
+        missing_auth_exception, eosio::testing::fc_exception_message_starts_with("missing authority"));
+
+    BOOST_REQUIRE_EXCEPTION(setstatediff(true),
+        eosio_assert_message_exception,
+        eosio_assert_message_is("state diff requires evm_version >= 3"));
+
+    setgasprices({.overhead_price=5, .storage_price=6});
+    setversion(3, evm_account_name);
+    produce_blocks(2*180);
+
+    // Disabled by default
+    auto trace = transfer_token("alice"_n, evm_account_name, make_asset(to_bridge), evm1.address_0x());
+    get_event_from_trace<evm_test::evmtx_v3>(evmtx_data(trace));
+
+    setstatediff(true);
+
+    // Bridge transfer: the destination account is created with the bridged balance
+    trace = transfer_token("alice"_n, evm_account_name, make_asset(to_bridge), evm1.address_0x());
+    auto event = get_event_from_trace<evm_test::evmtx_v4>(evmtx_data(trace));
+    BOOST_REQUIRE(event.eos_evm_version == 3);
+    BOOST_REQUIRE(event.overhead_price == 5);
+    BOOST_REQUIRE(event.storage_price == 6);
+
+    auto acc = find_change(event, [&](const evm_test::state_change& c) {
+        return std::holds_alternative<evm_test::account_change>(c) && std::get<evm_test::account_change>(c).address == to_bytes(evm1.address);
+    });
+    BOOST_REQUIRE(acc != event.state_diff.end());
+    const auto& evm1_change = std::get<evm_test::account_change>(*acc);
+    BOOST_REQUIRE(evm1_change.current.has_value());
+    BOOST_REQUIRE(!evm1_change.reset);
+    BOOST_REQUIRE(evm1_change.current->nonce == 0);
+    BOOST_REQUIRE(intx::be::unsafe::load<intx::uint256>((const uint8_t*)evm1_change.current->balance.data()) == *evm_balance(evm1));
+
+    // Contract deployment carries the new code
+    auto [deploy_trace, contract_address] = deploy_test_contract(evm1);
+    event = get_event_from_trace<evm_test::evmtx_v4>(evmtx_data(deploy_trace));
+    auto code = find_change(event, [&](const evm_test::state_change& c) {
+        return std::holds_alternative<evm_test::code_change>(c) && std::get<evm_test::code_change>(c).address == to_bytes(contract_address);
+    });
+    BOOST_REQUIRE(code != event.state_diff.end());
+    BOOST_REQUIRE(!std::get<evm_test::code_change>(*code).code.empty());
+
+    // Storage writes
+    auto txn = generate_tx(contract_address, 0, 1'000'000);
+    txn.data = *evmc::from_hex(increment_);
+    evm1.sign(txn);
+    trace = pushtx(txn);
+    event = get_event_from_trace<evm_test::evmtx_v4>(evmtx_data(trace));
+    auto slot = find_change(event, [&](const evm_test::state_change& c) {
+        return std::holds_alternative<evm_test::storage_change>(c) && std::get<evm_test::storage_change>(c).address == to_bytes(contract_address);
+    });
+    BOOST_REQUIRE(slot != event.state_diff.end());
+    BOOST_REQUIRE(std::get<evm_test::storage_change>(*slot).value == to_bytes(intx::uint256(1)));
+
+    setstatediff(false);
+    trace = transfer_token("alice"_n, evm_account_name, make_asset(to_bridge), evm1.address_0x());
+    get_event_from_trace<evm_test::evmtx_v3>(evmtx_data(trace));
+
+} FC_LOG_AND_RETHROW()
+
 BOOST_AUTO_TEST_SUITE_END()